@@ -141,12 +141,12 @@ else
     OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_I2C
     COMMON_VPATH += $(DRIVER_PATH)/eeprom
     QUANTUM_LIB_SRC += i2c_master.c
-    SRC += eeprom_driver.c eeprom_i2c.c
+    SRC += eeprom_driver.c eeprom_i2c.c eeprom_write_queue.c
   else ifeq ($(strip $(EEPROM_DRIVER)), spi)
     OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_SPI
     COMMON_VPATH += $(DRIVER_PATH)/eeprom
     QUANTUM_LIB_SRC += spi_master.c
-    SRC += eeprom_driver.c eeprom_spi.c
+    SRC += eeprom_driver.c eeprom_spi.c eeprom_write_queue.c
   else ifeq ($(strip $(EEPROM_DRIVER)), transient)
     OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_TRANSIENT
     COMMON_VPATH += $(DRIVER_PATH)/eeprom
@@ -282,6 +282,7 @@ endif
     SRC += $(QUANTUM_DIR)/color.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix_drivers.c
+    SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix_compositor.c
     SRC += $(LIB_PATH)/lib8tion/lib8tion.c
     CIE1931_CURVE := yes
     RGB_KEYCODES_ENABLE := yes
@@ -466,6 +467,21 @@ ifeq ($(strip $(ENCODER_ENABLE)), yes)
     OPT_DEFS += -DENCODER_ENABLE
 endif
 
+ifeq ($(strip $(KEYSTROKE_TRACE_ENABLE)), yes)
+    OPT_DEFS += -DKEYSTROKE_TRACE_ENABLE
+    SRC += $(QUANTUM_DIR)/keystroke_trace.c
+endif
+
+ifeq ($(strip $(LATENCY_PROBE_ENABLE)), yes)
+    OPT_DEFS += -DLATENCY_PROBE_ENABLE
+    SRC += $(QUANTUM_DIR)/latency_probe.c
+endif
+
+ifeq ($(strip $(SCAN_PROFILER_ENABLE)), yes)
+    OPT_DEFS += -DSCAN_PROFILER_ENABLE
+    SRC += $(QUANTUM_DIR)/scan_profiler.c
+endif
+
 ifeq ($(strip $(VELOCIKEY_ENABLE)), yes)
     OPT_DEFS += -DVELOCIKEY_ENABLE
     SRC += $(QUANTUM_DIR)/velocikey.c
@@ -19,6 +19,152 @@
 
 #include "eeprom_driver.h"
 
+#if defined(EXTERNAL_EEPROM_ASYNC_WRITE) && (defined(EEPROM_I2C) || defined(EEPROM_SPI))
+#    include "eeprom_write_queue.h"
+#else
+#    define eeprom_write_queue_task()
+#    define eeprom_write_queue_drain()
+#endif
+
+#ifdef EEPROM_WRITE_BEHIND
+#    include "timer.h"
+
+#    ifndef EEPROM_WRITE_BEHIND_LINES
+#        define EEPROM_WRITE_BEHIND_LINES 8
+#    endif
+
+// Lines are aligned to their size, so keep it a power of two no bigger than the EEPROM page
+#    ifndef EEPROM_WRITE_BEHIND_LINE_SIZE
+#        define EEPROM_WRITE_BEHIND_LINE_SIZE 16
+#    endif
+#    if EEPROM_WRITE_BEHIND_LINE_SIZE > 32 || (EEPROM_WRITE_BEHIND_LINE_SIZE & (EEPROM_WRITE_BEHIND_LINE_SIZE - 1)) != 0
+#        error EEPROM_WRITE_BEHIND_LINE_SIZE must be a power of two, 32 at most
+#    endif
+
+// Milliseconds without writes before the cache starts writing back
+#    ifndef EEPROM_WRITE_BEHIND_DELAY
+#        define EEPROM_WRITE_BEHIND_DELAY 1000
+#    endif
+
+typedef struct {
+    uintptr_t base;   // address of data[0]
+    uint32_t  dirty;  // one bit per byte not written to storage yet, zero if the line is free
+    uint8_t   data[EEPROM_WRITE_BEHIND_LINE_SIZE];
+} write_behind_line_t;
+
+static write_behind_line_t lines[EEPROM_WRITE_BEHIND_LINES];
+static uint8_t             next_eviction = 0;
+static uint16_t            last_write;
+
+static inline uint32_t dirty_mask(uint8_t offset, uint8_t len) { return (len >= 32 ? UINT32_MAX : ((UINT32_C(1) << len) - 1)) << offset; }
+
+static void write_behind_flush_line(write_behind_line_t *line) {
+    // write each run of dirty bytes in one go
+    uint8_t i = 0;
+    while (line->dirty) {
+        while (!(line->dirty & (UINT32_C(1) << i))) i++;
+        uint8_t len = 0;
+        while (i + len < EEPROM_WRITE_BEHIND_LINE_SIZE && (line->dirty & (UINT32_C(1) << (i + len)))) len++;
+        eeprom_storage_write_block(&line->data[i], (void *)(line->base + i), len);
+        line->dirty &= ~dirty_mask(i, len);
+        i += len;
+    }
+}
+
+static write_behind_line_t *write_behind_line(uintptr_t base) {
+    write_behind_line_t *free_line = NULL;
+    for (uint8_t i = 0; i < EEPROM_WRITE_BEHIND_LINES; i++) {
+        if (!lines[i].dirty) {
+            if (!free_line) free_line = &lines[i];
+        } else if (lines[i].base == base) {
+            return &lines[i];
+        }
+    }
+
+    if (!free_line) {
+        // out of lines, write one back early to make room
+        free_line     = &lines[next_eviction];
+        next_eviction = (next_eviction + 1) % EEPROM_WRITE_BEHIND_LINES;
+        write_behind_flush_line(free_line);
+    }
+    free_line->base = base;
+    return free_line;
+}
+
+void eeprom_driver_task(void) {
+    eeprom_write_queue_task();
+
+    if (timer_elapsed(last_write) < EEPROM_WRITE_BEHIND_DELAY) return;
+
+    // one line per pass keeps the main loop responsive
+    for (uint8_t i = 0; i < EEPROM_WRITE_BEHIND_LINES; i++) {
+        if (lines[i].dirty) {
+            write_behind_flush_line(&lines[i]);
+            return;
+        }
+    }
+}
+
+void eeprom_driver_flush(void) {
+    for (uint8_t i = 0; i < EEPROM_WRITE_BEHIND_LINES; i++) {
+        write_behind_flush_line(&lines[i]);
+    }
+    eeprom_write_queue_drain();
+}
+
+void eeprom_driver_erase(void) {
+    // pending writes are older than the erase
+    for (uint8_t i = 0; i < EEPROM_WRITE_BEHIND_LINES; i++) {
+        lines[i].dirty = 0;
+    }
+    eeprom_storage_erase();
+}
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    uintptr_t start = (uintptr_t)addr;
+    eeprom_storage_read_block(buf, addr, len);
+
+    // pending writes win over what is in storage
+    for (uint8_t i = 0; i < EEPROM_WRITE_BEHIND_LINES; i++) {
+        write_behind_line_t *line = &lines[i];
+        if (!line->dirty || line->base + EEPROM_WRITE_BEHIND_LINE_SIZE <= start || line->base >= start + len) continue;
+        for (uint8_t j = 0; j < EEPROM_WRITE_BEHIND_LINE_SIZE; j++) {
+            uintptr_t target = line->base + j;
+            if ((line->dirty & (UINT32_C(1) << j)) && target >= start && target < start + len) {
+                ((uint8_t *)buf)[target - start] = line->data[j];
+            }
+        }
+    }
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    const uint8_t *src    = (const uint8_t *)buf;
+    uintptr_t      target = (uintptr_t)addr;
+
+    while (len > 0) {
+        uintptr_t            base   = target & ~(uintptr_t)(EEPROM_WRITE_BEHIND_LINE_SIZE - 1);
+        uint8_t              offset = target - base;
+        uint8_t              count  = (len < EEPROM_WRITE_BEHIND_LINE_SIZE - offset) ? len : EEPROM_WRITE_BEHIND_LINE_SIZE - offset;
+        write_behind_line_t *line   = write_behind_line(base);
+
+        memcpy(&line->data[offset], src, count);
+        line->dirty |= dirty_mask(offset, count);
+
+        src += count;
+        target += count;
+        len -= count;
+    }
+    last_write = timer_read();
+}
+
+#else
+
+void eeprom_driver_task(void) { eeprom_write_queue_task(); }
+
+void eeprom_driver_flush(void) { eeprom_write_queue_drain(); }
+
+#endif  // EEPROM_WRITE_BEHIND
+
 uint8_t eeprom_read_byte(const uint8_t *addr) {
     uint8_t ret = 0;
     eeprom_read_block(&ret, addr, 1);
@@ -20,3 +20,25 @@
 
 void eeprom_driver_init(void);
 void eeprom_driver_erase(void);
+
+/* Write back data held by the write-behind cache or the external EEPROM write queue: as the main loop goes, or all of it right away. */
+void eeprom_driver_task(void);
+void eeprom_driver_flush(void);
+
+#ifdef EEPROM_WRITE_BEHIND
+/*
+    With the write-behind cache enabled, eeprom_driver.c provides the public
+    block and erase functions on top of the cache. Drivers define
+    EEPROM_DRIVER_STORAGE before including this header, so their own
+    implementations are renamed to the storage functions underneath it.
+*/
+void eeprom_storage_erase(void);
+void eeprom_storage_read_block(void *buf, const void *addr, size_t len);
+void eeprom_storage_write_block(const void *buf, void *addr, size_t len);
+
+#    ifdef EEPROM_DRIVER_STORAGE
+#        define eeprom_driver_erase eeprom_storage_erase
+#        define eeprom_read_block eeprom_storage_read_block
+#        define eeprom_write_block eeprom_storage_write_block
+#    endif
+#endif
@@ -36,7 +36,13 @@
 #include "wait.h"
 #include "i2c_master.h"
 #include "eeprom.h"
+#define EEPROM_DRIVER_STORAGE
+#include "eeprom_driver.h"
 #include "eeprom_i2c.h"
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+#    include "timer.h"
+#    include "eeprom_write_queue.h"
+#endif
 
 // #define DEBUG_EEPROM_OUTPUT
 
@@ -53,6 +59,57 @@ static inline void fill_target_address(uint8_t *buffer, const void *addr) {
     }
 }
 
+static void i2c_eeprom_page_write(uintptr_t target_addr, const uint8_t *data, uint16_t write_length) {
+    uint8_t complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + EXTERNAL_EEPROM_PAGE_SIZE];
+
+    fill_target_address(complete_packet, (const void *)target_addr);
+    for (uint16_t i = 0; i < write_length; i++) {
+        complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + i] = data[i];
+    }
+
+#if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
+    dprintf("[EEPROM W] 0x%04X: ", ((int)target_addr));
+    for (uint16_t i = 0; i < write_length; i++) {
+        dprintf(" %02X", (int)(data[i]));
+    }
+    dprintf("\n");
+#endif  // DEBUG_EEPROM_OUTPUT
+
+    i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS(target_addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE + write_length, 100);
+}
+
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+static uint16_t page_program_timer;
+
+void eeprom_page_program_start(uintptr_t addr, const uint8_t *data, uint16_t len) {
+#    if defined(EXTERNAL_EEPROM_WP_PIN)
+    setPinOutput(EXTERNAL_EEPROM_WP_PIN);
+    writePin(EXTERNAL_EEPROM_WP_PIN, 0);
+#    endif
+
+    i2c_eeprom_page_write(addr, data, len);
+    page_program_timer = timer_read();
+}
+
+bool eeprom_page_program_busy(void) {
+    if (timer_elapsed(page_program_timer) < EXTERNAL_EEPROM_WRITE_TIME) {
+        /* Acknowledge polling: the EEPROM doesn't respond until the write cycle is over */
+        uint8_t address_packet[EXTERNAL_EEPROM_ADDRESS_SIZE];
+        fill_target_address(address_packet, 0);
+        if (i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS(0), address_packet, EXTERNAL_EEPROM_ADDRESS_SIZE, 1) != I2C_STATUS_SUCCESS) {
+            return true;
+        }
+    }
+
+#    if defined(EXTERNAL_EEPROM_WP_PIN)
+    /* We are setting the WP pin to high in a way that requires at least two bit-flips to change back to 0 */
+    writePin(EXTERNAL_EEPROM_WP_PIN, 1);
+    setPinInputHigh(EXTERNAL_EEPROM_WP_PIN);
+#    endif
+    return false;
+}
+#endif
+
 void eeprom_driver_init(void) {
     i2c_init();
 #if defined(EXTERNAL_EEPROM_WP_PIN)
@@ -82,9 +139,19 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
     uint8_t complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE];
     fill_target_address(complete_packet, addr);
 
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+    /* The EEPROM doesn't respond while programming a page */
+    eeprom_write_queue_wait();
+#endif
+
     i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS((uintptr_t)addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE, 100);
     i2c_receive(EXTERNAL_EEPROM_I2C_ADDRESS((uintptr_t)addr), buf, len, 100);
 
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+    /* Writes still queued are newer than what was read */
+    eeprom_write_queue_overlay(buf, (uintptr_t)addr, len);
+#endif
+
 #if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
     dprintf("[EEPROM R] 0x%04X: ", ((int)addr));
     for (size_t i = 0; i < len; ++i) {
@@ -95,11 +162,10 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
 }
 
 void eeprom_write_block(const void *buf, void *addr, size_t len) {
-    uint8_t   complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + EXTERNAL_EEPROM_PAGE_SIZE];
     uint8_t * read_buf    = (uint8_t *)buf;
     uintptr_t target_addr = (uintptr_t)addr;
 
-#if defined(EXTERNAL_EEPROM_WP_PIN)
+#if defined(EXTERNAL_EEPROM_WP_PIN) && !defined(EXTERNAL_EEPROM_ASYNC_WRITE)
     setPinOutput(EXTERNAL_EEPROM_WP_PIN);
     writePin(EXTERNAL_EEPROM_WP_PIN, 0);
 #endif
@@ -111,28 +177,19 @@ void eeprom_write_block(const void *buf, void *addr, size_t len) {
             write_length = len;
         }
 
-        fill_target_address(complete_packet, (const void *)target_addr);
-        for (uint8_t i = 0; i < write_length; i++) {
-            complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + i] = read_buf[i];
-        }
-
-#if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
-        dprintf("[EEPROM W] 0x%04X: ", ((int)target_addr));
-        for (uint8_t i = 0; i < write_length; i++) {
-            dprintf(" %02X", (int)(read_buf[i]));
-        }
-        dprintf("\n");
-#endif  // DEBUG_EEPROM_OUTPUT
-
-        i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS((uintptr_t)addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE + write_length, 100);
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+        eeprom_write_queue_push(target_addr, read_buf, write_length);
+#else
+        i2c_eeprom_page_write(target_addr, read_buf, write_length);
         wait_ms(EXTERNAL_EEPROM_WRITE_TIME);
+#endif
 
         read_buf += write_length;
         target_addr += write_length;
         len -= write_length;
     }
 
-#if defined(EXTERNAL_EEPROM_WP_PIN)
+#if defined(EXTERNAL_EEPROM_WP_PIN) && !defined(EXTERNAL_EEPROM_ASYNC_WRITE)
     /* We are setting the WP pin to high in a way that requires at least two bit-flips to change back to 0 */
     writePin(EXTERNAL_EEPROM_WP_PIN, 1);
     setPinInputHigh(EXTERNAL_EEPROM_WP_PIN);
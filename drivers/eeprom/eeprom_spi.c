@@ -35,7 +35,12 @@
 #include "timer.h"
 #include "spi_master.h"
 #include "eeprom.h"
+#define EEPROM_DRIVER_STORAGE
+#include "eeprom_driver.h"
 #include "eeprom_spi.h"
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+#    include "eeprom_write_queue.h"
+#endif
 
 #define CMD_WREN 6
 #define CMD_WRDI 4
@@ -78,6 +83,71 @@ static void spi_eeprom_transmit_address(uintptr_t addr) {
     spi_transmit(buffer, EXTERNAL_EEPROM_ADDRESS_SIZE);
 }
 
+static bool spi_eeprom_page_write(uintptr_t target_addr, const uint8_t *data, uint16_t write_length) {
+    //-------------------------------------------------
+    // Enable writes
+    bool res = spi_eeprom_start();
+    if (!res) {
+        dprint("failed to start SPI for write-enable\n");
+        return false;
+    }
+
+    spi_write(CMD_WREN);
+    spi_stop();
+
+    //-------------------------------------------------
+    // Perform the write
+    res = spi_eeprom_start();
+    if (!res) {
+        dprint("failed to start SPI for write\n");
+        return false;
+    }
+
+#if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
+    dprintf("[EEPROM W] 0x%08lX: ", ((uint32_t)(uintptr_t)target_addr));
+    for (size_t i = 0; i < write_length; i++) {
+        dprintf(" %02X", (int)(uint8_t)(data[i]));
+    }
+    dprintf("\n");
+#endif  // DEBUG_EEPROM_OUTPUT
+
+    spi_write(CMD_WRITE);
+    spi_eeprom_transmit_address(target_addr);
+    spi_transmit(data, write_length);
+    spi_stop();
+    return true;
+}
+
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+static uint32_t page_program_timer;
+
+void eeprom_page_program_start(uintptr_t addr, const uint8_t *data, uint16_t len) {
+    spi_eeprom_page_write(addr, data, len);
+    page_program_timer = timer_read32();
+}
+
+bool eeprom_page_program_busy(void) {
+    if (!spi_eeprom_start()) {
+        dprint("failed to start SPI for WIP check\n");
+        return false;
+    }
+
+    spi_write(CMD_RDSR);
+    spi_status_t response = spi_read();
+    spi_stop();
+    if (!(response & SR_WIP)) {
+        return false;
+    }
+
+    // a missing EEPROM reads back as always busy when MISO floats high
+    if (timer_elapsed32(page_program_timer) >= EXTERNAL_EEPROM_SPI_TIMEOUT) {
+        dprint("SPI timeout for WIP check, page write dropped\n");
+        return false;
+    }
+    return true;
+}
+#endif
+
 //----------------------------------------------------------------------------------------------------------------------
 
 void eeprom_driver_init(void) { spi_init(); }
@@ -129,6 +199,11 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
     spi_eeprom_transmit_address((uintptr_t)addr);
     spi_receive(buf, len);
 
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+    /* Writes still queued are newer than what was read */
+    eeprom_write_queue_overlay(buf, (uintptr_t)addr, len);
+#endif
+
 #if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
     dprintf("[EEPROM R] 0x%08lX: ", ((uint32_t)(uintptr_t)addr));
     for (size_t i = 0; i < len; ++i) {
@@ -141,7 +216,9 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
 }
 
 void eeprom_write_block(const void *buf, void *addr, size_t len) {
-    bool      res;
+#ifndef EXTERNAL_EEPROM_ASYNC_WRITE
+    bool res;
+#endif
     uint8_t * read_buf    = (uint8_t *)buf;
     uintptr_t target_addr = (uintptr_t)addr;
 
@@ -152,6 +229,9 @@ void eeprom_write_block(const void *buf, void *addr, size_t len) {
             write_length = len;
         }
 
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+        eeprom_write_queue_push(target_addr, read_buf, write_length);
+#else
         //-------------------------------------------------
         // Wait for the write-in-progress bit to be cleared
         res = spi_eeprom_start();
@@ -167,43 +247,17 @@ void eeprom_write_block(const void *buf, void *addr, size_t len) {
             return;
         }
 
-        //-------------------------------------------------
-        // Enable writes
-        res = spi_eeprom_start();
-        if (!res) {
-            dprint("failed to start SPI for write-enable\n");
-            return;
-        }
-
-        spi_write(CMD_WREN);
-        spi_stop();
-
-        //-------------------------------------------------
-        // Perform the write
-        res = spi_eeprom_start();
-        if (!res) {
-            dprint("failed to start SPI for write\n");
+        if (!spi_eeprom_page_write(target_addr, read_buf, write_length)) {
             return;
         }
-
-#if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
-        dprintf("[EEPROM W] 0x%08lX: ", ((uint32_t)(uintptr_t)target_addr));
-        for (size_t i = 0; i < write_length; i++) {
-            dprintf(" %02X", (int)(uint8_t)(read_buf[i]));
-        }
-        dprintf("\n");
-#endif  // DEBUG_EEPROM_OUTPUT
-
-        spi_write(CMD_WRITE);
-        spi_eeprom_transmit_address(target_addr);
-        spi_transmit(read_buf, write_length);
-        spi_stop();
+#endif
 
         read_buf += write_length;
         target_addr += write_length;
         len -= write_length;
     }
 
+#ifndef EXTERNAL_EEPROM_ASYNC_WRITE
     //-------------------------------------------------
     // Disable writes
     res = spi_eeprom_start();
@@ -214,4 +268,5 @@ void eeprom_write_block(const void *buf, void *addr, size_t len) {
 
     spi_write(CMD_WRDI);
     spi_stop();
+#endif
 }
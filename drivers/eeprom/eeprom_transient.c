@@ -17,6 +17,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#define EEPROM_DRIVER_STORAGE
 #include "eeprom_driver.h"
 #include "eeprom_transient.h"
 
@@ -0,0 +1,120 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef EXTERNAL_EEPROM_ASYNC_WRITE
+
+#    include "eeprom_write_queue.h"
+#    if defined(EEPROM_I2C)
+#        include "eeprom_i2c.h"
+#    elif defined(EEPROM_SPI)
+#        include "eeprom_spi.h"
+#    endif
+
+#    ifndef EXTERNAL_EEPROM_WRITE_QUEUE_SIZE
+#        define EXTERNAL_EEPROM_WRITE_QUEUE_SIZE 4
+#    endif
+
+typedef struct {
+    uintptr_t addr;
+    uint16_t  len;
+    uint8_t   data[EXTERNAL_EEPROM_PAGE_SIZE];
+} queued_write_t;
+
+static queued_write_t queue[EXTERNAL_EEPROM_WRITE_QUEUE_SIZE];
+static uint8_t        head      = 0;
+static uint8_t        count     = 0;
+static bool           in_flight = false;  // queue[head] has been sent and is being programmed
+
+#    define QUEUE_INDEX(i) (((head) + (i)) % EXTERNAL_EEPROM_WRITE_QUEUE_SIZE)
+
+static void write_queue_start(void) {
+    if (in_flight || !count) return;
+    eeprom_page_program_start(queue[head].addr, queue[head].data, queue[head].len);
+    in_flight = true;
+}
+
+static bool write_queue_complete(void) {
+    if (in_flight) {
+        if (eeprom_page_program_busy()) return false;
+        head      = QUEUE_INDEX(1);
+        in_flight = false;
+        count--;
+    }
+    return true;
+}
+
+void eeprom_write_queue_push(uintptr_t addr, const uint8_t *data, uint16_t len) {
+    // extend the newest write when it is to the same page and touches this one
+    if (count && !(count == 1 && in_flight)) {
+        queued_write_t *last = &queue[QUEUE_INDEX(count - 1)];
+        uintptr_t       page = last->addr - last->addr % EXTERNAL_EEPROM_PAGE_SIZE;
+        if (addr >= page && addr + len <= page + EXTERNAL_EEPROM_PAGE_SIZE && addr <= last->addr + last->len && addr + len >= last->addr) {
+            if (addr < last->addr) {
+                memmove(&last->data[last->addr - addr], last->data, last->len);
+                last->len += last->addr - addr;
+                last->addr = addr;
+            }
+            memcpy(&last->data[addr - last->addr], data, len);
+            if (addr + len > last->addr + last->len) last->len = addr + len - last->addr;
+            return;
+        }
+    }
+
+    while (count == EXTERNAL_EEPROM_WRITE_QUEUE_SIZE) {
+        eeprom_write_queue_task();
+    }
+
+    queued_write_t *write = &queue[QUEUE_INDEX(count)];
+    write->addr           = addr;
+    write->len            = len;
+    memcpy(write->data, data, len);
+    count++;
+
+    // get the EEPROM working on it straight away if it is idle
+    write_queue_start();
+}
+
+void eeprom_write_queue_task(void) {
+    if (write_queue_complete()) write_queue_start();
+}
+
+void eeprom_write_queue_drain(void) {
+    while (count) {
+        eeprom_write_queue_task();
+    }
+}
+
+void eeprom_write_queue_wait(void) {
+    while (!write_queue_complete()) {
+    }
+}
+
+void eeprom_write_queue_overlay(void *buf, uintptr_t addr, size_t len) {
+    // oldest first, so newer writes win
+    for (uint8_t i = 0; i < count; i++) {
+        queued_write_t *write = &queue[QUEUE_INDEX(i)];
+        uintptr_t       start = write->addr > addr ? write->addr : addr;
+        uintptr_t       end   = write->addr + write->len < addr + len ? write->addr + write->len : addr + len;
+        if (start < end) {
+            memcpy((uint8_t *)buf + (start - addr), &write->data[start - write->addr], end - start);
+        }
+    }
+}
+
+#endif  // EXTERNAL_EEPROM_ASYNC_WRITE
@@ -0,0 +1,47 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    Page programs waiting for an external EEPROM. Writes are queued a page at
+    a time and started one after the other from the main loop, instead of
+    waiting out each write cycle.
+*/
+
+/* Queue a write, which must not cross a page boundary. Only blocks while the queue is full. */
+void eeprom_write_queue_push(uintptr_t addr, const uint8_t *data, uint16_t len);
+
+/* Poll the page being programmed, and start the next one once it is done. */
+void eeprom_write_queue_task(void);
+
+/* Wait for every queued write to reach the EEPROM. */
+void eeprom_write_queue_drain(void);
+
+/* Wait for the page being programmed, leaving the EEPROM free for a read. */
+void eeprom_write_queue_wait(void);
+
+/* Apply queued writes on top of data read from the EEPROM. */
+void eeprom_write_queue_overlay(void *buf, uintptr_t addr, size_t len);
+
+/* Provided by the driver: send a page program without waiting for it, and check whether it is still in progress.
+   A page program which doesn't finish within the driver's timeout is given up on, and reported as done. */
+void eeprom_page_program_start(uintptr_t addr, const uint8_t *data, uint16_t len);
+bool eeprom_page_program_busy(void);
@@ -74,6 +74,9 @@ void apa102_setleds(LED_TYPE *start_led, uint16_t num_leds) {
 // Overwrite the default rgblight_call_driver to use apa102 driver
 void rgblight_call_driver(LED_TYPE *start_led, uint8_t num_leds) { apa102_setleds(start_led, num_leds); }
 
+// Frames are sent synchronously
+bool rgblight_driver_ready(void) { return true; }
+
 void static apa102_init(void) {
     setPinOutput(RGB_DI_PIN);
     setPinOutput(RGB_CI_PIN);
@@ -34,6 +34,7 @@ extern const is31_led __flash g_is31_leds[DRIVER_LED_TOTAL];
 void IS31FL3733_init(uint8_t addr, uint8_t sync);
 bool IS31FL3733_write_register(uint8_t addr, uint8_t reg, uint8_t data);
 bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer);
+bool IS31FL3733_write_pwm_buffer_changes(uint8_t addr, uint8_t index);
 
 void IS31FL3733_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
 void IS31FL3733_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
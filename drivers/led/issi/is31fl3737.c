@@ -19,6 +19,7 @@
 #include "is31fl3737.h"
 #include "i2c_master.h"
 #include "wait.h"
+#include <string.h>
 
 // This is a 7-bit address, that gets left-shifted and bit 0
 // set to 0 for write, 1 for read (as per I2C protocol)
@@ -56,6 +57,12 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// Changed PWM registers separated by at most this many unchanged ones are sent
+// in the same burst, as that is cheaper than addressing a new transfer.
+#ifndef ISSI_PWM_MERGE_GAP
+#    define ISSI_PWM_MERGE_GAP 3
+#endif
+
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20];
 
@@ -69,6 +76,11 @@ uint8_t g_twi_transfer_buffer[20];
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
 bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
 
+// The PWM registers as last written to each device. IS31FL3737_init() invalidates
+// the shadows, as it cannot tell which one belongs to the device it resets.
+uint8_t g_pwm_buffer_sent[DRIVER_COUNT][192];
+bool    g_pwm_buffer_sent_valid[DRIVER_COUNT] = {false};
+
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {0};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
 
@@ -111,6 +123,63 @@ void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     }
 }
 
+bool IS31FL3737_write_pwm_buffer_changes(uint8_t addr, uint8_t index) {
+    // assumes PG1 is already selected
+    // Registers of failed transactions are left dirty for the next update.
+    uint8_t *pwm_buffer = g_pwm_buffer[index];
+    uint8_t *pwm_sent   = g_pwm_buffer_sent[index];
+    bool     success    = true;
+
+    if (!g_pwm_buffer_sent_valid[index]) {
+        // the device contents are unknown, so make every register differ
+        for (uint8_t i = 0; i < 192; i++) {
+            pwm_sent[i] = ~pwm_buffer[i];
+        }
+        g_pwm_buffer_sent_valid[index] = true;
+    }
+
+    for (uint8_t start = 0; start < 192; start++) {
+        if (pwm_buffer[start] == pwm_sent[start]) {
+            continue;
+        }
+
+        // extend the burst over following changes, bridging short runs of
+        // unchanged registers, until it fills g_twi_transfer_buffer[]
+        uint8_t end = start + 1;
+        for (uint8_t i = end; i < 192 && i - start < sizeof(g_twi_transfer_buffer) - 1; i++) {
+            if (pwm_buffer[i] != pwm_sent[i]) {
+                end = i + 1;
+            } else if (i - end >= ISSI_PWM_MERGE_GAP) {
+                break;
+            }
+        }
+
+        uint8_t length           = end - start;
+        g_twi_transfer_buffer[0] = start;
+        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + start, length);
+
+        bool sent = false;
+#if ISSI_PERSISTENCE > 0
+        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) == 0) {
+                sent = true;
+                break;
+            }
+        }
+#else
+        sent = i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) == 0;
+#endif
+        if (sent) {
+            memcpy(pwm_sent + start, pwm_buffer + start, length);
+        } else {
+            success = false;
+        }
+
+        start = end - 1;
+    }
+    return success;
+}
+
 void IS31FL3737_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -150,6 +219,10 @@ void IS31FL3737_init(uint8_t addr) {
 
     // Wait 10ms to ensure the device has woken up.
     wait_ms(10);
+
+    // Resend the whole frame on the next update.
+    memset(g_pwm_buffer_sent_valid, false, sizeof(g_pwm_buffer_sent_valid));
+    memset(g_pwm_buffer_update_required, true, sizeof(g_pwm_buffer_update_required));
 }
 
 void IS31FL3737_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
@@ -204,9 +277,9 @@ void IS31FL3737_update_pwm_buffers(uint8_t addr, uint8_t index) {
         IS31FL3737_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3737_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        IS31FL3737_write_pwm_buffer(addr, g_pwm_buffer[index]);
+        // retry any registers that did not make it next time
+        g_pwm_buffer_update_required[index] = !IS31FL3737_write_pwm_buffer_changes(addr, index);
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3737_update_led_control_registers(uint8_t addr, uint8_t index) {
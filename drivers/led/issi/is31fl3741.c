@@ -61,7 +61,15 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// Changed PWM registers separated by at most this many unchanged ones are sent
+// in the same burst, as that is cheaper than addressing a new transfer.
+#ifndef ISSI_PWM_MERGE_GAP
+#    define ISSI_PWM_MERGE_GAP 3
+#endif
+
 #define ISSI_MAX_LEDS 351
+// PWM registers for the first 180 LEDs live on PG0, the rest on PG1
+#define ISSI_PWM_PAGE_SIZE 180
 
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20] = {0xFF};
@@ -76,6 +84,11 @@ uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
 bool    g_pwm_buffer_update_required[DRIVER_COUNT]        = {false};
 bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
+// The PWM registers as last written to each device. IS31FL3741_init() invalidates
+// the shadows, so the first update after it writes all of the registers.
+uint8_t g_pwm_buffer_sent[DRIVER_COUNT][ISSI_MAX_LEDS];
+bool    g_pwm_buffer_sent_valid[DRIVER_COUNT] = {false};
+
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
 void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
@@ -138,6 +151,66 @@ bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     return true;
 }
 
+bool IS31FL3741_write_pwm_buffer_changes(uint8_t addr, uint8_t index) {
+    // Registers of failed transactions are left dirty for the next update.
+    uint8_t *pwm_buffer = g_pwm_buffer[index];
+    uint8_t *pwm_sent   = g_pwm_buffer_sent[index];
+    uint8_t  page       = UINT8_MAX;
+    bool     success    = true;
+
+    for (uint16_t start = 0; start < ISSI_MAX_LEDS; start++) {
+        if (pwm_buffer[start] == pwm_sent[start]) {
+            continue;
+        }
+
+        // extend the burst over following changes, bridging short runs of unchanged
+        // registers, until it fills g_twi_transfer_buffer[] or reaches the end of the page
+        uint16_t page_end = start < ISSI_PWM_PAGE_SIZE ? ISSI_PWM_PAGE_SIZE : ISSI_MAX_LEDS;
+        uint16_t end      = start + 1;
+        for (uint16_t i = end; i < page_end && i - start < sizeof(g_twi_transfer_buffer) - 1; i++) {
+            if (pwm_buffer[i] != pwm_sent[i]) {
+                end = i + 1;
+            } else if (i - end >= ISSI_PWM_MERGE_GAP) {
+                break;
+            }
+        }
+
+        // only switch pages when a change needs it
+        uint8_t start_page = start < ISSI_PWM_PAGE_SIZE ? ISSI_PAGE_PWM0 : ISSI_PAGE_PWM1;
+        if (page != start_page) {
+            page = start_page;
+            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
+            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, page);
+        }
+
+        uint8_t length           = end - start;
+        g_twi_transfer_buffer[0] = start % ISSI_PWM_PAGE_SIZE;
+        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + start, length);
+
+        bool sent = true;
+#if ISSI_PERSISTENCE > 0
+        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+                sent = false;
+                break;
+            }
+        }
+#else
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+            sent = false;
+        }
+#endif
+        if (sent) {
+            memcpy(pwm_sent + start, pwm_buffer + start, length);
+        } else {
+            success = false;
+        }
+
+        start = end - 1;
+    }
+    return success;
+}
+
 void IS31FL3741_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -163,6 +236,10 @@ void IS31FL3741_init(uint8_t addr) {
 
     // Wait 10ms to ensure the device has woken up.
     wait_ms(10);
+
+    // Resend the whole frame on the next update.
+    memset(g_pwm_buffer_sent_valid, false, sizeof(g_pwm_buffer_sent_valid));
+    memset(g_pwm_buffer_update_required, true, sizeof(g_pwm_buffer_update_required));
 }
 
 void IS31FL3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
@@ -208,10 +285,17 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 
 void IS31FL3741_update_pwm_buffers(uint8_t addr, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
-        IS31FL3741_write_pwm_buffer(addr, g_pwm_buffer[index]);
+        if (!g_pwm_buffer_sent_valid[index]) {
+            if (IS31FL3741_write_pwm_buffer(addr, g_pwm_buffer[index])) {
+                memcpy(g_pwm_buffer_sent[index], g_pwm_buffer[index], ISSI_MAX_LEDS);
+                g_pwm_buffer_sent_valid[index] = true;
+            }
+            g_pwm_buffer_update_required[index] = !g_pwm_buffer_sent_valid[index];
+        } else {
+            // retry any registers that did not make it next time
+            g_pwm_buffer_update_required[index] = !IS31FL3741_write_pwm_buffer_changes(addr, index);
+        }
     }
-
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
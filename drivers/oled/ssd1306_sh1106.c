@@ -132,6 +132,11 @@ uint32_t oled_scroll_timeout;
 uint16_t oled_update_timeout;
 #endif
 
+// The display keeps its write position between transfers, so the blocks up to oled_window_end can
+// be sent one per render without setting the window again, as long as they come in order
+static uint8_t oled_window_next = 0;
+static uint8_t oled_window_end  = 0;
+
 // Internal variables to reduce math instructions
 
 #if defined(__AVR__)
@@ -226,6 +231,7 @@ bool oled_init(oled_rotation_t rotation) {
 #endif
 
     oled_clear();
+    oled_window_end  = 0;
     oled_initialized = true;
     oled_active      = true;
     oled_scrolling   = false;
@@ -240,10 +246,24 @@ void oled_clear(void) {
     oled_dirty  = OLED_ALL_BLOCKS_MASK;
 }
 
-static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
-    // Calculate commands to set memory addressing bounds.
-    uint8_t start_page   = OLED_BLOCK_SIZE * update_start / OLED_DISPLAY_WIDTH;
-    uint8_t start_column = OLED_BLOCK_SIZE * update_start % OLED_DISPLAY_WIDTH;
+// Sets the window to the run of dirty blocks from update_start, and returns the block past its end
+static uint8_t calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
+    uint16_t start        = OLED_BLOCK_SIZE * update_start;
+    uint8_t  start_page   = start / OLED_DISPLAY_WIDTH;
+    uint8_t  start_column = start % OLED_DISPLAY_WIDTH;
+    uint16_t page_end     = (start_page + 1) * OLED_DISPLAY_WIDTH;
+    uint8_t  update_end   = update_start + 1;
+
+    // The window wraps back to its first column at the end of each page, so it can only span
+    // several pages when it starts on the first column. Page addressing can't span pages at all.
+    while (update_end < OLED_BLOCK_COUNT && (oled_dirty & ((OLED_BLOCK_TYPE)1 << update_end))) {
+#if (OLED_IC == OLED_IC_SH1106)
+        if (OLED_BLOCK_SIZE * (update_end + 1) > page_end) break;
+#else
+        if (start_column && OLED_BLOCK_SIZE * (update_end + 1) > page_end) break;
+#endif
+        ++update_end;
+    }
 #if (OLED_IC == OLED_IC_SH1106)
     // Commands for Page Addressing Mode. Sets starting page and column; has no end bound.
     // Column value must be split into high and low nybble and sent as two commands.
@@ -255,11 +275,18 @@ static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
     cmd_array[5] = NOP;
 #else
     // Commands for use in Horizontal Addressing mode.
-    cmd_array[1] = start_column;
+    uint16_t end = OLED_BLOCK_SIZE * update_end;
+    if (end <= page_end) {
+        cmd_array[1] = start_column;
+        cmd_array[2] = (end - 1) % OLED_DISPLAY_WIDTH;
+    } else {
+        cmd_array[1] = 0;
+        cmd_array[2] = OLED_DISPLAY_WIDTH - 1;
+    }
     cmd_array[4] = start_page;
-    cmd_array[2] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) % OLED_DISPLAY_WIDTH + cmd_array[1];
-    cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) / OLED_DISPLAY_WIDTH - 1;
+    cmd_array[5] = (end - 1) / OLED_DISPLAY_WIDTH;
 #endif
+    return update_end;
 }
 
 static void calc_bounds_90(uint8_t update_start, uint8_t *cmd_array) {
@@ -270,19 +297,36 @@ static void calc_bounds_90(uint8_t update_start, uint8_t *cmd_array) {
     cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_HEIGHT - 1) % OLED_DISPLAY_HEIGHT / 8;
 }
 
-uint8_t crot(uint8_t a, int8_t n) {
-    const uint8_t mask = 0x7;
-    n &= mask;
-    return a << n | a >> (-n & mask);
-}
-
+// Transposes an 8x8 block of pixels, 32 bits at a time (Hacker's Delight, figure 7-6): bit i of
+// src[j] ends up as bit 7 - j of dest[i]
 static void rotate_90(const uint8_t *src, uint8_t *dest) {
-    for (uint8_t i = 0, shift = 7; i < 8; ++i, --shift) {
-        uint8_t selector = (1 << i);
-        for (uint8_t j = 0; j < 8; ++j) {
-            dest[i] |= crot(src[j] & selector, shift - (int8_t)j);
-        }
-    }
+    uint32_t x = ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3];
+    uint32_t y = ((uint32_t)src[4] << 24) | ((uint32_t)src[5] << 16) | ((uint32_t)src[6] << 8) | src[7];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCC;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    // the transpose has row 0 at the top, the display wants it at the bottom
+    dest[0] = y;
+    dest[1] = y >> 8;
+    dest[2] = y >> 16;
+    dest[3] = y >> 24;
+    dest[4] = x;
+    dest[5] = x >> 8;
+    dest[6] = x >> 16;
+    dest[7] = x >> 24;
 }
 
 void oled_render(void) {
@@ -302,17 +346,23 @@ void oled_render(void) {
         ++update_start;
     }
 
-    // Set column & page position
+    // Set column & page position, unless the block continues the current window
     static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
+    bool           set_window      = true;
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        calc_bounds(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
+        if (update_start == oled_window_next && update_start < oled_window_end) {
+            set_window = false;
+        } else {
+            oled_window_end = calc_bounds(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
+        }
     } else {
         calc_bounds_90(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
     }
 
     // Send column & page position
-    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
+    if (set_window && I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
         print("oled_render offset command failed\n");
+        oled_window_end = 0;
         return;
     }
 
@@ -320,8 +370,10 @@ void oled_render(void) {
         // Send render data chunk as is
         if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
             print("oled_render data failed\n");
+            oled_window_end = 0;
             return;
         }
+        oled_window_next = update_start + 1;
     } else {
         // Rotate the render chunks
         const static uint8_t source_map[] = OLED_SOURCE_MAP;
@@ -686,8 +738,9 @@ bool oled_scroll_off(void) {
             print("oled_scroll_off cmd failed\n");
             return oled_scrolling;
         }
-        oled_scrolling = false;
-        oled_dirty     = OLED_ALL_BLOCKS_MASK;
+        oled_scrolling  = false;
+        oled_dirty      = OLED_ALL_BLOCKS_MASK;
+        oled_window_end = 0;
     }
     return !oled_scrolling;
 }
@@ -102,6 +102,9 @@ uint8_t adns_read(uint8_t reg_addr) {
 
 void adns_init() {
     setPinOutput(SPI_SS_PIN);
+#ifdef ADNS9800_MOTION_PIN
+    setPinInputHigh(ADNS9800_MOTION_PIN);
+#endif
 
     spi_init();
 
@@ -177,6 +180,13 @@ static int16_t convertDeltaToInt(uint8_t high, uint8_t low) {
 report_adns_t adns_get_report(void) {
     report_adns_t report = {0, 0};
 
+#ifdef ADNS9800_MOTION_PIN
+    // MOTION is pulled low while there is motion to read, skip the transfer otherwise
+    if (readPin(ADNS9800_MOTION_PIN)) {
+        return report;
+    }
+#endif
+
     adns_spi_start();
 
     // start burst mode
@@ -187,17 +197,12 @@ report_adns_t adns_get_report(void) {
     uint8_t motion = spi_read();
 
     if (motion & 0x80) {
-        // clear observation register
-        spi_read();
-
-        // delta registers
-        uint8_t delta_x_l = spi_read();
-        uint8_t delta_x_h = spi_read();
-        uint8_t delta_y_l = spi_read();
-        uint8_t delta_y_h = spi_read();
+        // Observation, Delta_X_L, Delta_X_H, Delta_Y_L, Delta_Y_H in one transfer
+        uint8_t burst[5];
+        spi_receive(burst, sizeof(burst));
 
-        report.x = convertDeltaToInt(delta_x_h, delta_x_l);
-        report.y = convertDeltaToInt(delta_y_h, delta_y_l);
+        report.x = convertDeltaToInt(burst[2], burst[1]);
+        report.y = convertDeltaToInt(burst[4], burst[3]);
     }
 
     // clear residual motion
@@ -74,6 +74,10 @@
 #define REG_LiftCutoff_Tune2 0x65
 
 bool _inBurst = false;
+#ifdef PMW3360_MOTION_PIN
+// lift state from the last burst, reported again while the transfer is skipped
+static bool _isOnSurface = true;
+#endif
 
 void print_byte(uint8_t byte) { dprintf("%c%c%c%c%c%c%c%c|", (byte & 0x80 ? '1' : '0'), (byte & 0x40 ? '1' : '0'), (byte & 0x20 ? '1' : '0'), (byte & 0x10 ? '1' : '0'), (byte & 0x08 ? '1' : '0'), (byte & 0x04 ? '1' : '0'), (byte & 0x02 ? '1' : '0'), (byte & 0x01 ? '1' : '0')); }
 
@@ -139,6 +143,9 @@ uint16_t pmw_get_cpi(void) {
 
 bool pmw_spi_init(void) {
     setPinOutput(PMW3360_CS_PIN);
+#ifdef PMW3360_MOTION_PIN
+    setPinInputHigh(PMW3360_MOTION_PIN);
+#endif
 
     spi_init();
     _inBurst = false;
@@ -219,6 +226,16 @@ bool pmw_check_signature(void) {
 }
 
 report_pmw_t pmw_read_burst(void) {
+    report_pmw_t data = {0};
+
+#ifdef PMW3360_MOTION_PIN
+    // MOTION is pulled low while there is motion to read, skip the transfer otherwise
+    if (_inBurst && readPin(PMW3360_MOTION_PIN)) {
+        data.isOnSurface = _isOnSurface;
+        return data;
+    }
+#endif
+
     if (!_inBurst) {
         dprintf("burst on");
         spi_write_adv(REG_Motion_Burst, 0x00);
@@ -229,22 +246,18 @@ report_pmw_t pmw_read_burst(void) {
     spi_write(REG_Motion_Burst);
     wait_us(35);  // waits for tSRAD
 
-    report_pmw_t data;
-    data.motion = 0;
-    data.dx     = 0;
-    data.mdx    = 0;
-    data.dy     = 0;
-    data.mdx    = 0;
-
-    data.motion = spi_read();
-    spi_write(0x00);  // skip Observation
-    data.dx  = spi_read();
-    data.mdx = spi_read();
-    data.dy  = spi_read();
-    data.mdy = spi_read();
+    // Motion, Observation, Delta_X_L, Delta_X_H, Delta_Y_L, Delta_Y_H in one transfer
+    uint8_t burst[6];
+    spi_receive(burst, sizeof(burst));
 
     spi_stop();
 
+    data.motion = burst[0];
+    data.dx     = burst[2];
+    data.mdx    = burst[3];
+    data.dy     = burst[4];
+    data.mdy    = burst[5];
+
     if (debug_mouse) {
         print_byte(data.motion);
         print_byte(data.dx);
@@ -256,13 +269,14 @@ report_pmw_t pmw_read_burst(void) {
 
     data.isMotion    = (data.motion & 0x80) != 0;
     data.isOnSurface = (data.motion & 0x08) == 0;
+#ifdef PMW3360_MOTION_PIN
+    _isOnSurface = data.isOnSurface;
+#endif
     data.dx |= (data.mdx << 8);
     data.dx = data.dx * -1;
     data.dy |= (data.mdy << 8);
     data.dy = data.dy * -1;
 
-    spi_stop();
-
     if (data.motion & 0b111) {  // panic recovery, sometimes burst mode works weird.
         _inBurst = false;
     }
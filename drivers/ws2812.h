@@ -38,3 +38,11 @@
  *         - Wait 50us to reset the LEDs
  */
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+/* Frame pacing
+ *
+ * Returns true when the driver can accept the next frame without it being
+ * dropped or stalling on the transfer in flight. Drivers which send
+ * synchronously are always ready.
+ */
+bool ws2812_ready(void);
@@ -0,0 +1,147 @@
+"""Caching of data parsed from the keyboard tree.
+
+Results are memoized for the life of the process. Results of `persistent()` functions are also stored under `.build/cache` and reused by later runs as long as the mtime and size of every file they depend on stay the same.
+"""
+import copy
+import functools
+import hashlib
+import os
+import pickle
+from pathlib import Path
+
+from milc import cli
+
+from qmk.constants import BUILD_DIR
+
+# Bump this when the format of a cached result changes in a way the fingerprints can't see
+CACHE_VERSION = 1
+
+CACHE_DIR = Path(BUILD_DIR) / 'cache'
+
+# Everything a parsed result can depend on besides the keyboard's own files
+GLOBAL_DEPENDENCIES = 'data', 'layouts', 'lib/python/qmk'
+
+_memoized = []
+
+
+def _stat_line(path):
+    try:
+        st = os.stat(path)
+        return f'{path}:{st.st_mtime_ns}:{st.st_size}\n'
+
+    except OSError:
+        return f'{path}:-\n'
+
+
+def fingerprint(*paths):
+    """Returns a digest of the mtime and size of `paths`.
+
+    Directories are walked recursively, skipping `__pycache__`. Files that don't exist are included as well, so creating them changes the result.
+    """
+    digest = hashlib.sha1()
+
+    for path in map(str, paths):
+        if not os.path.isdir(path):
+            digest.update(_stat_line(path).encode())
+            continue
+
+        for root, dirs, files in os.walk(path):
+            dirs[:] = sorted(dir for dir in dirs if dir != '__pycache__')
+            digest.update(f'{root}/\n'.encode())
+
+            for name in sorted(files):
+                digest.update(_stat_line(os.path.join(root, name)).encode())
+
+    return digest.hexdigest()
+
+
+@functools.lru_cache(maxsize=None)
+def global_fingerprint():
+    """Returns the fingerprint of the files every cached result depends on.
+
+    This is only computed once per process.
+    """
+    return fingerprint(*GLOBAL_DEPENDENCIES) + str(CACHE_VERSION)
+
+
+def memoize(func):
+    """Memoize the result of `func` for the life of the process.
+
+    A copy is returned on every call so callers are free to modify the result.
+    """
+    cached_func = functools.lru_cache(maxsize=None)(func)
+
+    @functools.wraps(func)
+    def wrapper(*args):
+        return copy.deepcopy(cached_func(*args))
+
+    wrapper.cache_clear = cached_func.cache_clear
+    wrapper.uncached = func
+    _memoized.append(wrapper)
+
+    return wrapper
+
+
+def persistent(dependencies, on_load=None):
+    """Memoize the result of a function and store it on disk.
+
+    Args:
+
+        dependencies
+            A function that takes the same arguments and returns the files and directories the result depends on, see `fingerprint()`.
+
+        on_load
+            Called with the result when it was loaded from disk, for example to repeat messages logged while generating it.
+    """
+    def decorator(func):
+        cache_dir = CACHE_DIR / func.__name__
+
+        @functools.wraps(func)
+        def wrapper(*args):
+            key = global_fingerprint() + fingerprint(*dependencies(*args))
+            cache_file = cache_dir / (hashlib.sha1(repr(args).encode()).hexdigest() + '.pickle')
+
+            try:
+                with cache_file.open('rb') as fd:
+                    cached_key, cached_args, result = pickle.load(fd)
+
+            except Exception:
+                # Missing, unreadable or written by a different version, so generate it again
+                cached_key = None
+
+            if cached_key == key and cached_args == args:
+                if on_load:
+                    on_load(result)
+
+                return result
+
+            result = func(*args)
+
+            try:
+                cache_dir.mkdir(parents=True, exist_ok=True)
+                tmp_file = cache_file.with_suffix(f'.{os.getpid()}.tmp')
+
+                with tmp_file.open('wb') as fd:
+                    pickle.dump((key, args, result), fd, protocol=pickle.HIGHEST_PROTOCOL)
+
+                os.replace(tmp_file, cache_file)
+
+            except OSError as e:
+                cli.log.debug('Could not write cache file %s: %s', cache_file, e)
+
+            return result
+
+        return memoize(wrapper)
+
+    return decorator
+
+
+def cache_clear():
+    """Forget everything memoized in this process.
+
+    Use this after changing files that were already parsed. The on-disk cache does not need to be cleared, it notices changes by itself.
+    """
+    global_fingerprint.cache_clear()
+
+    for func in _memoized:
+        func.cache_clear()
@@ -1,25 +1,120 @@
 """This script automates the generation of the QMK API data.
 """
+from functools import partial
+from multiprocessing import Pool, cpu_count
 from pathlib import Path
 from shutil import copyfile
+import filecmp
 import json
 
 from milc import cli
 
+from qmk.cache import CACHE_DIR, fingerprint, global_fingerprint
 from qmk.datetime import current_datetime
-from qmk.info import info_json
+from qmk.info import info_json, info_json_files
 from qmk.json_encoders import InfoJSONEncoder
 from qmk.json_schema import json_load
 from qmk.keyboard import find_readme, list_keyboards
 
+api_data_dir = Path('api_data')
+v1_dir = api_data_dir / 'v1'
+fingerprints_file = CACHE_DIR / 'generate_api.json'  # The fingerprint of every keyboard as of the last run, for --incremental
+
+
+def _write_json(file, new_json):
+    """Write `new_json` to `file`, unless the only thing that changed is `last_updated`.
+
+    Returns True if the file was written.
+    """
+    if file.exists():
+        try:
+            old_data = json.loads(file.read_text())
+
+        except ValueError:
+            old_data = None
+
+        if isinstance(old_data, dict):
+            new_data = json.loads(new_json)
+            old_data.pop('last_updated', None)
+            new_data.pop('last_updated', None)
+
+            if old_data == new_data:
+                return False
+
+    file.write_text(new_json)
+    return True
+
+
+def _encode_keyboard(kb_info):
+    """Encode the data of one keyboard the way it appears inside keyboards.json.
+
+    Encoding keyboards.json is most of the work of this command, this allows it to be split across the workers.
+    """
+    encoder = InfoJSONEncoder()
+    encoder.indentation_level = 2
+
+    return encoder.encode(kb_info)
+
+
+def _encode_keyboard_all(last_updated, keyboard_blocks):
+    """Assemble keyboards.json from the output of `_encode_keyboard()`, identical to encoding it with InfoJSONEncoder.
+    """
+    if not keyboard_blocks:
+        return json.dumps({'last_updated': last_updated, 'keyboards': {}}, cls=InfoJSONEncoder)
+
+    indent = InfoJSONEncoder.indentation_char * 4
+    keyboards = ',\n'.join(f'{indent * 2}{json.dumps(name)}: {keyboard_blocks[name]}' for name in sorted(keyboard_blocks))
+
+    return f'{{\n{indent}"keyboards": {{\n{keyboards}\n{indent}}},\n{indent}"last_updated": {json.dumps(last_updated)}\n}}'
+
+
+def _generate_keyboard(last_updated, dry_run, job):
+    """Generate and write the API data for a single keyboard.
+
+    This runs in a worker process. The previous data is reused when the keyboard's fingerprint matches `previous_fingerprint`.
+    """
+    keyboard_name, previous_fingerprint = job
+    keyboard_dir = v1_dir / 'keyboards' / keyboard_name
+    keyboard_info = keyboard_dir / 'info.json'
+    keyboard_readme = keyboard_dir / 'readme.md'
+    keyboard_readme_src = find_readme(keyboard_name)
+    keyboard_fingerprint = global_fingerprint() + fingerprint(*info_json_files(keyboard_name), *filter(None, [keyboard_readme_src]))
+
+    if previous_fingerprint == keyboard_fingerprint and keyboard_info.exists():
+        try:
+            kb_info = json.loads(keyboard_info.read_text())['keyboards'][keyboard_name]
+            return keyboard_name, keyboard_fingerprint, kb_info, _encode_keyboard(kb_info)
+
+        except (ValueError, KeyError):
+            cli.log.debug('Regenerating unreadable file %s', keyboard_info)
+
+    try:
+        kb_info = info_json(keyboard_name)
+
+    except SystemExit:
+        # info_json() has already logged why
+        return keyboard_name, None, None, None
+
+    if not dry_run:
+        keyboard_dir.mkdir(parents=True, exist_ok=True)
+
+        if _write_json(keyboard_info, json.dumps({'last_updated': last_updated, 'keyboards': {keyboard_name: kb_info}})):
+            cli.log.debug('Wrote file %s', keyboard_info)
+
+        if keyboard_readme_src and not (keyboard_readme.exists() and filecmp.cmp(keyboard_readme_src, keyboard_readme, shallow=False)):
+            copyfile(keyboard_readme_src, keyboard_readme)
+            cli.log.debug('Copied %s -> %s', keyboard_readme_src, keyboard_readme)
+
+    return keyboard_name, keyboard_fingerprint, kb_info, _encode_keyboard(kb_info)
+
 
 @cli.argument('-n', '--dry-run', arg_only=True, action='store_true', help="Don't write the data to disk.")
+@cli.argument('-i', '--incremental', arg_only=True, action='store_true', help="Only regenerate keyboards whose files changed since the last run.")
+@cli.argument('-j', '--parallel', type=int, default=0, help="Set the number of worker processes; 0 means one per CPU core.")
 @cli.subcommand('Creates a new keymap for the keyboard of your choosing', hidden=False if cli.config.user.developer else True)
 def generate_api(cli):
     """Generates the QMK API data.
     """
-    api_data_dir = Path('api_data')
-    v1_dir = api_data_dir / 'v1'
     keyboard_all_file = v1_dir / 'keyboards.json'  # A massive JSON containing everything
     keyboard_list_file = v1_dir / 'keyboard_list.json'  # A simple list of keyboard targets
     keyboard_aliases_file = v1_dir / 'keyboard_aliases.json'  # A list of historical keyboard names and their new name
@@ -31,24 +126,38 @@ def generate_api(cli):
 
     kb_all = {}
     usb_list = {}
+    keyboard_blocks = {}
+    fingerprints = {}
+    failed = []
+    previous_fingerprints = {}
+    last_updated = current_datetime()
+
+    if cli.args.incremental and fingerprints_file.exists():
+        try:
+            previous_fingerprints = json.loads(fingerprints_file.read_text())
+
+        except ValueError:
+            cli.log.warning('Ignoring unreadable file %s', fingerprints_file)
 
     # Generate and write keyboard specific JSON files
-    for keyboard_name in list_keyboards():
-        kb_all[keyboard_name] = info_json(keyboard_name)
-        keyboard_dir = v1_dir / 'keyboards' / keyboard_name
-        keyboard_info = keyboard_dir / 'info.json'
-        keyboard_readme = keyboard_dir / 'readme.md'
-        keyboard_readme_src = find_readme(keyboard_name)
+    jobs = [(keyboard_name, previous_fingerprints.get(keyboard_name)) for keyboard_name in list_keyboards()]
+    generate_keyboard = partial(_generate_keyboard, last_updated, cli.args.dry_run)
+    processes = cli.config.generate_api.parallel or cpu_count()
 
-        keyboard_dir.mkdir(parents=True, exist_ok=True)
-        keyboard_json = json.dumps({'last_updated': current_datetime(), 'keyboards': {keyboard_name: kb_all[keyboard_name]}})
-        if not cli.args.dry_run:
-            keyboard_info.write_text(keyboard_json)
-            cli.log.debug('Wrote file %s', keyboard_info)
+    if processes > 1:
+        with Pool(processes) as pool:
+            results = pool.map(generate_keyboard, jobs, chunksize=8)
+    else:
+        results = map(generate_keyboard, jobs)
+
+    for keyboard_name, keyboard_fingerprint, kb_info, keyboard_block in results:
+        if kb_info is None:
+            failed.append(keyboard_name)
+            continue
 
-            if keyboard_readme_src:
-                copyfile(keyboard_readme_src, keyboard_readme)
-                cli.log.debug('Copied %s -> %s', keyboard_readme_src, keyboard_readme)
+        kb_all[keyboard_name] = kb_info
+        keyboard_blocks[keyboard_name] = keyboard_block
+        fingerprints[keyboard_name] = keyboard_fingerprint
 
         if 'usb' in kb_all[keyboard_name]:
             usb = kb_all[keyboard_name]['usb']
@@ -62,26 +171,27 @@ def generate_api(cli):
             if 'vid' in usb and 'pid' in usb:
                 usb_list[usb['vid']][usb['pid']][keyboard_name] = usb
 
+    if failed:
+        cli.log.error('Could not generate API data for: %s', ', '.join(failed))
+        return False
+
     # Generate data for the global files
     keyboard_list = sorted(kb_all)
     keyboard_aliases = json_load(Path('data/mappings/keyboard_aliases.json'))
     keyboard_metadata = {
-        'last_updated': current_datetime(),
+        'last_updated': last_updated,
         'keyboards': keyboard_list,
         'keyboard_aliases': keyboard_aliases,
         'usb': usb_list,
     }
 
     # Write the global JSON files
-    keyboard_all_json = json.dumps({'last_updated': current_datetime(), 'keyboards': kb_all}, cls=InfoJSONEncoder)
-    usb_json = json.dumps({'last_updated': current_datetime(), 'usb': usb_list}, cls=InfoJSONEncoder)
-    keyboard_list_json = json.dumps({'last_updated': current_datetime(), 'keyboards': keyboard_list}, cls=InfoJSONEncoder)
-    keyboard_aliases_json = json.dumps({'last_updated': current_datetime(), 'keyboard_aliases': keyboard_aliases}, cls=InfoJSONEncoder)
-    keyboard_metadata_json = json.dumps(keyboard_metadata, cls=InfoJSONEncoder)
-
     if not cli.args.dry_run:
-        keyboard_all_file.write_text(keyboard_all_json)
-        usb_file.write_text(usb_json)
-        keyboard_list_file.write_text(keyboard_list_json)
-        keyboard_aliases_file.write_text(keyboard_aliases_json)
-        keyboard_metadata_file.write_text(keyboard_metadata_json)
+        _write_json(keyboard_all_file, _encode_keyboard_all(last_updated, keyboard_blocks))
+        _write_json(usb_file, json.dumps({'last_updated': last_updated, 'usb': usb_list}, cls=InfoJSONEncoder))
+        _write_json(keyboard_list_file, json.dumps({'last_updated': last_updated, 'keyboards': keyboard_list}, cls=InfoJSONEncoder))
+        _write_json(keyboard_aliases_file, json.dumps({'last_updated': last_updated, 'keyboard_aliases': keyboard_aliases}, cls=InfoJSONEncoder))
+        _write_json(keyboard_metadata_file, json.dumps(keyboard_metadata, cls=InfoJSONEncoder))
+
+        fingerprints_file.parent.mkdir(parents=True, exist_ok=True)
+        fingerprints_file.write_text(json.dumps(fingerprints))
@@ -7,10 +7,11 @@ import jsonschema
 from dotty_dict import dotty
 from milc import cli
 
+from qmk.cache import persistent
 from qmk.constants import CHIBIOS_PROCESSORS, LUFA_PROCESSORS, VUSB_PROCESSORS
 from qmk.c_parse import find_layouts
 from qmk.json_schema import deep_update, json_load, validate
-from qmk.keyboard import config_h, rules_mk
+from qmk.keyboard import config_h, resolve_keyboard, rules_mk
 from qmk.keymap import list_keymaps
 from qmk.makefile import parse_rules_mk_file
 from qmk.math import compute
@@ -32,8 +33,39 @@ def _remove_newlines_from_labels(layouts):
                 key['label'] = key['label'].split('\n')[0]
 
 
+def info_json_files(keyboard):
+    """Returns the files and directories info_json() reads for a keyboard.
+    """
+    files = []
+
+    for kb in dict.fromkeys([str(keyboard), resolve_keyboard(keyboard)]):
+        cur_dir = Path('keyboards')
+
+        for dir in Path(kb).parts:
+            cur_dir = cur_dir / dir
+            files.extend(cur_dir / name for name in ('rules.mk', 'config.h', 'info.json', f'{dir}.h', 'keymaps'))
+
+        # Everything below the keyboard itself, including revisions and the *.h files _find_missing_layouts() looks at
+        files.append(cur_dir)
+
+    return files
+
+
+def _replay_messages(info_data):
+    """Log the errors and warnings of an info.json that was loaded from the cache again.
+    """
+    for message in info_data['parse_errors']:
+        cli.log.error('%s: %s', info_data['keyboard_folder'], message)
+
+    for message in info_data['parse_warnings']:
+        cli.log.warning('%s: %s', info_data['keyboard_folder'], message)
+
+
+@persistent(info_json_files, on_load=_replay_messages)
 def info_json(keyboard):
     """Generate the info.json data for a specific keyboard.
+
+    The result is cached, see `qmk.cache`.
     """
     cur_dir = Path('keyboards')
     root_rules_mk = parse_rules_mk_file(cur_dir / keyboard / 'rules.mk')
@@ -2,6 +2,8 @@
 """
 import json
 from decimal import Decimal
+from json.encoder import encode_basestring, encode_basestring_ascii
+from math import isfinite
 
 newline = '\n'
 
@@ -52,9 +54,36 @@ class QMKJSONEncoder(json.JSONEncoder):
         elif isinstance(obj, dict):
             return self.encode_dict(obj)
 
+        elif obj is None or isinstance(obj, (str, int, float)):
+            # Much faster than the generic encoder for the many small values in a layout
+            return self.encode_primitive(obj)
+
         else:
             return super().encode(obj)
 
+    def encode_primitive(self, obj):
+        """Encode None, str, bool, int or float the same way json.dumps() does.
+        """
+        if isinstance(obj, str):
+            return encode_basestring_ascii(obj) if self.ensure_ascii else encode_basestring(obj)
+
+        elif obj is None:
+            return 'null'
+
+        elif obj is True:
+            return 'true'
+
+        elif obj is False:
+            return 'false'
+
+        elif isinstance(obj, int):
+            return int.__repr__(obj)
+
+        elif isfinite(obj):
+            return float.__repr__(obj)
+
+        return super().encode(obj)
+
     def primitives_only(self, obj):
         """Returns true if the object doesn't have any container type objects (list, tuple, dict).
         """
@@ -4,9 +4,9 @@ from array import array
 from math import ceil
 from pathlib import Path
 import os
-from glob import glob
 
 import qmk.path
+from qmk.cache import memoize
 from qmk.c_parse import parse_config_h_file
 from qmk.json_schema import json_load
 from qmk.makefile import parse_rules_mk_file
@@ -98,16 +98,25 @@ def keyboard_completer(prefix, action, parser, parsed_args):
     return list_keyboards()
 
 
+@memoize
 def list_keyboards():
     """Returns a list of all keyboards.
     """
     # We avoid pathlib here because this is performance critical code.
-    kb_wildcard = os.path.join(base_path, "**", "rules.mk")
-    paths = [path for path in glob(kb_wildcard, recursive=True) if 'keymaps' not in path]
+    paths = []
+
+    for root, dirs, files in os.walk(base_path):
+        # Keymaps hold most of the files in the tree and never contain keyboards
+        if 'keymaps' in dirs:
+            dirs.remove('keymaps')
+
+        if 'rules.mk' in files and 'keymaps' not in root:
+            paths.append(os.path.join(root, 'rules.mk'))
 
     return sorted(set(map(resolve_keyboard, map(_find_name, paths))))
 
 
+@memoize
 def resolve_keyboard(keyboard):
     cur_dir = Path('keyboards')
     rules = parse_rules_mk_file(cur_dir / keyboard / 'rules.mk')
@@ -117,6 +126,7 @@ def resolve_keyboard(keyboard):
     return keyboard
 
 
+@memoize
 def config_h(keyboard):
     """Parses all the config.h files for a keyboard.
 
@@ -137,6 +147,7 @@ def config_h(keyboard):
     return config
 
 
+@memoize
 def rules_mk(keyboard):
     """Get a rules.mk for a keyboard
 
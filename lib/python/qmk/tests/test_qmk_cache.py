@@ -0,0 +1,56 @@
+import os
+from pathlib import Path
+from tempfile import TemporaryDirectory
+
+import qmk.cache
+import qmk.info
+
+
+def test_fingerprint_changes_with_file():
+    with TemporaryDirectory() as tmp_dir:
+        test_file = Path(tmp_dir) / 'rules.mk'
+        missing = qmk.cache.fingerprint(tmp_dir, Path(tmp_dir) / 'config.h')
+
+        test_file.write_text('MCU = atmega32u4\n')
+        created = qmk.cache.fingerprint(tmp_dir, Path(tmp_dir) / 'config.h')
+        assert created != missing
+
+        os.utime(test_file, ns=(0, 0))
+        assert qmk.cache.fingerprint(tmp_dir, Path(tmp_dir) / 'config.h') != created
+
+
+def test_persistent_reuses_result():
+    calls = []
+    cache_dir = qmk.cache.CACHE_DIR
+
+    with TemporaryDirectory() as tmp_dir:
+        qmk.cache.CACHE_DIR = Path(tmp_dir) / 'cache'
+        dependency = Path(tmp_dir) / 'rules.mk'
+        dependency.write_text('MCU = atmega32u4\n')
+
+        def generate(name):
+            calls.append(name)
+            return {'name': name, 'rules': dependency.read_text()}
+
+        def load():
+            qmk.cache.cache_clear()
+            return qmk.cache.persistent(lambda name: [dependency])(generate)('test')
+
+        try:
+            assert load() == {'name': 'test', 'rules': 'MCU = atmega32u4\n'}
+            assert load() == {'name': 'test', 'rules': 'MCU = atmega32u4\n'}
+            assert calls == ['test']
+
+            dependency.write_text('MCU = STM32F303\n')
+            assert load() == {'name': 'test', 'rules': 'MCU = STM32F303\n'}
+            assert calls == ['test', 'test']
+
+        finally:
+            qmk.cache.CACHE_DIR = cache_dir
+
+
+def test_info_json_returns_copy():
+    info_data = qmk.info.info_json('handwired/pytest/basic')
+    info_data['keyboard_name'] = 'modified'
+
+    assert qmk.info.info_json('handwired/pytest/basic')['keyboard_name'] != 'modified'
@@ -36,6 +36,9 @@
 
 static inline void ws2812_sendarray_mask(uint8_t *data, uint16_t datlen, uint8_t masklo, uint8_t maskhi);
 
+// Frames are sent synchronously
+bool ws2812_ready(void) { return true; }
+
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {
     DDRx_ADDRESS(RGB_DI_PIN) |= pinmask(RGB_DI_PIN);
 
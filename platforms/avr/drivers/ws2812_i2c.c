@@ -15,6 +15,9 @@
 
 void ws2812_init(void) { i2c_init(); }
 
+// Frames are sent synchronously
+bool ws2812_ready(void) { return true; }
+
 // Setleds for standard RGB
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
     static bool s_init = false;
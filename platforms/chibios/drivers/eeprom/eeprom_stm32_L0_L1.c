@@ -18,6 +18,7 @@
 #include <string.h>
 
 #include <hal.h>
+#define EEPROM_DRIVER_STORAGE
 #include "eeprom_driver.h"
 #include "eeprom_stm32_L0_L1.h"
 
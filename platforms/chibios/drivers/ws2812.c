@@ -76,6 +76,9 @@ void sendByte(uint8_t byte) {
 
 void ws2812_init(void) { palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE); }
 
+// Frames are sent synchronously
+bool ws2812_ready(void) { return true; }
+
 // Setleds for standard RGB
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
     static bool s_init = false;
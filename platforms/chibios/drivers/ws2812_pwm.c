@@ -297,6 +297,9 @@ void ws2812_write_led(uint16_t led_number, uint8_t r, uint8_t g, uint8_t b) {
     }
 }
 
+// The DMA streams the frame buffer continuously, a new frame is picked up on the next pass
+bool ws2812_ready(void) { return true; }
+
 // Setleds for standard RGB
 void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
     static bool s_init = false;
@@ -79,45 +79,79 @@
 #define DATA_SIZE (BYTES_FOR_LED * RGBLED_NUM)
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * 1250))
 #define PREAMBLE_SIZE 4
+// Padded so every buffer, and every LED within it, stays word aligned
+#define TXBUF_SIZE ((PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE + 3) & ~3)
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+// Circular and synchronous sends never have a frame in flight while the next one is
+// being written, everything else ping-pongs between two buffers.
+#if defined(WS2812_SPI_USE_CIRCULAR_BUFFER) || defined(WS2812_SPI_SYNC)
+#    define WS2812_SPI_BUFFER_COUNT 1
+#else
+#    define WS2812_SPI_BUFFER_COUNT 2
+#    define WS2812_SPI_DOUBLE_BUFFER
+#endif
+
+static uint8_t txbuf[WS2812_SPI_BUFFER_COUNT][TXBUF_SIZE] __attribute__((aligned(4))) = {{0}};
+
+// Buffer the next frame is written into
+static uint8_t back_buffer = 0;
+
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+static volatile bool frame_pending = false;
+#endif
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
- * the ws2812b protocol, we use this helper function to translate bytes into
- * 0s and 1s for the LED (with the appropriate timing).
+ * the ws2812b protocol, we translate each bit of data into a 4 bit symbol
+ * (0b1110 for a 1, 0b1000 for a 0). This table holds the symbols for one
+ * nibble, laid out in transmit order, so a colour byte expands into a single
+ * 32 bit word.
  */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
-}
+static const uint16_t protocol_nibble_eq[16] = {
+    0x8888, 0x8E88, 0xE888, 0xEE88, 0x888E, 0x8E8E, 0xE88E, 0xEE8E, 0x88E8, 0x8EE8, 0xE8E8, 0xEEE8, 0x88EE, 0x8EEE, 0xE8EE, 0xEEEE,
+};
+
+static inline uint32_t get_protocol_eq(uint8_t data) { return protocol_nibble_eq[data >> 4] | ((uint32_t)protocol_nibble_eq[data & 0x0F] << 16); }
 
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+static void set_led_color_rgb(uint8_t* buf, LED_TYPE color, int pos) {
+    uint32_t* tx_start = (uint32_t*)&buf[PREAMBLE_SIZE + BYTES_FOR_LED * pos];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    tx_start[0] = get_protocol_eq(color.g);
+    tx_start[1] = get_protocol_eq(color.r);
+    tx_start[2] = get_protocol_eq(color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    tx_start[0] = get_protocol_eq(color.r);
+    tx_start[1] = get_protocol_eq(color.g);
+    tx_start[2] = get_protocol_eq(color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
+    tx_start[0] = get_protocol_eq(color.b);
+    tx_start[1] = get_protocol_eq(color.g);
+    tx_start[2] = get_protocol_eq(color.r);
 #endif
 }
 
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+// Must be called with the system locked, and only while the SPI is idle.
+static void start_back_buffer_send_i(void) {
+    spiStartSendI(&WS2812_SPI, sizeof(txbuf[0]), txbuf[back_buffer]);
+    back_buffer ^= 1;
+    frame_pending = false;
+}
+
+// Runs once the previous frame is on the wire; chains a frame queued meanwhile.
+static void ws2812_spi_end_cb(SPIDriver* spip) {
+    if (frame_pending) {
+        osalSysLockFromISR();
+        start_back_buffer_send_i();
+        osalSysUnlockFromISR();
+    }
+}
+#    define WS2812_SPI_END_CB ws2812_spi_end_cb
+#else
+#    define WS2812_SPI_END_CB NULL
+#endif
+
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_MOSI_OUTPUT_MODE);
 
@@ -126,13 +160,22 @@ void ws2812_init(void) {
 #endif  // WS2812_SPI_SCK_PIN
 
     // TODO: more dynamic baudrate
-    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
+    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, WS2812_SPI_END_CB, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
 
     spiAcquireBus(&WS2812_SPI);     /* Acquire ownership of the bus.    */
     spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiStartSend(&WS2812_SPI, sizeof(txbuf[0]), txbuf[0]);
+#endif
+}
+
+bool ws2812_ready(void) {
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+    // A new frame would otherwise replace the one still queued behind the transfer in flight
+    return !frame_pending;
+#else
+    return true;
 #endif
 }
 
@@ -143,17 +186,29 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+    // Drop any frame still waiting for the wire, it is about to be superseded
+    osalSysLock();
+    frame_pending = false;
+    osalSysUnlock();
+#endif
+
     for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+        set_led_color_rgb(txbuf[back_buffer], ledarray[i], i);
     }
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
-#ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
-#    ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
-#    else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
-#    endif
+    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms. The frame is written to the back buffer
+    // while the front buffer is on the wire, and queued behind it if the transfer is still running.
+    // Alternatively spiSend can be used to send synchronously.
+#if defined(WS2812_SPI_DOUBLE_BUFFER)
+    osalSysLock();
+    if (WS2812_SPI.state == SPI_READY) {
+        start_back_buffer_send_i();
+    } else {
+        frame_pending = true;
+    }
+    osalSysUnlock();
+#elif defined(WS2812_SPI_SYNC) && !defined(WS2812_SPI_USE_CIRCULAR_BUFFER)
+    spiSend(&WS2812_SPI, sizeof(txbuf[0]), txbuf[0]);
 #endif
 }
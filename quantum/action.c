@@ -31,6 +31,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    include "backlight.h"
 #endif
 
+#ifdef KEYSTROKE_TRACE_ENABLE
+#    include "keystroke_trace.h"
+#endif
+
 #ifdef DEBUG_ACTION
 #    include "debug.h"
 #else
@@ -69,6 +73,9 @@ void action_exec(keyevent_t event) {
         dprintln();
 #if defined(RETRO_TAPPING) || defined(RETRO_TAPPING_PER_KEY)
         retro_tapping_counter++;
+#endif
+#ifdef KEYSTROKE_TRACE_ENABLE
+        keystroke_trace_record(event);
 #endif
     }
 
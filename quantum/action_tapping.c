@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "action.h"
 #include "action_layer.h"
 #include "action_tapping.h"
@@ -44,14 +45,30 @@ __attribute__((weak)) bool get_permissive_hold(uint16_t keycode, keyrecord_t *re
 __attribute__((weak)) bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) { return false; }
 #    endif
 
-static keyrecord_t tapping_key                         = {};
-static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
-static uint8_t     waiting_buffer_head                 = 0;
-static uint8_t     waiting_buffer_tail                 = 0;
+#    if (WAITING_BUFFER_SIZE & (WAITING_BUFFER_SIZE - 1)) || WAITING_BUFFER_SIZE > 128
+#        error WAITING_BUFFER_SIZE must be a power of two, at most 128
+#    endif
+#    define WAITING_BUFFER_NEXT(i) (((i) + 1) & (WAITING_BUFFER_SIZE - 1))
+
+/* The buffered events are counted per direction and per key, by a hash of the key position, so
+ * looking for a key that isn't in the buffer doesn't have to walk it.
+ */
+#    define WAITING_BUFFER_KEY_BUCKETS 16
+#    define WAITING_BUFFER_KEY_BUCKET(key) (((key).col ^ ((key).row << 2)) & (WAITING_BUFFER_KEY_BUCKETS - 1))
+
+static keyrecord_t tapping_key                                        = {};
+static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE]                = {};
+static uint8_t     waiting_buffer_head                                = 0;
+static uint8_t     waiting_buffer_tail                                = 0;
+static uint8_t     waiting_buffer_keys[2][WAITING_BUFFER_KEY_BUCKETS] = {};
+static uint8_t     waiting_buffer_pressed                             = 0;
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
+static void waiting_buffer_deq(void);
+static void waiting_buffer_process(void);
 static void waiting_buffer_clear(void);
+static void waiting_buffer_resolve(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
 static void waiting_buffer_scan_tap(void);
@@ -70,12 +87,10 @@ void action_tapping_process(keyrecord_t record) {
             debug("\n");
         }
     } else {
-        if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+        while (!waiting_buffer_enq(record)) {
+            // overflow: settle the tap key holding the events back, then catch up on them
+            waiting_buffer_resolve();
+            waiting_buffer_process();
         }
     }
 
@@ -83,22 +98,47 @@ void action_tapping_process(keyrecord_t record) {
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            debug("processed: waiting_buffer[");
-            debug_dec(waiting_buffer_tail);
-            debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]);
-            debug("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (!IS_NOEVENT(record.event)) {
         debug("\n");
     }
 }
 
+/** \brief Process the waiting buffer
+ *
+ * Processes buffered events in order until one has to wait again.
+ */
+static void waiting_buffer_process(void) {
+    while (waiting_buffer_tail != waiting_buffer_head && process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+        debug("processed: waiting_buffer[");
+        debug_dec(waiting_buffer_tail);
+        debug("] = ");
+        debug_record(waiting_buffer[waiting_buffer_tail]);
+        debug("\n\n");
+        waiting_buffer_deq();
+    }
+}
+
+/** \brief Resolve an overflowing waiting buffer
+ *
+ * Events only wait behind a tap key whose tap or hold is still undecided. Deciding it as a hold,
+ * as the tapping term would have, lets them through without dropping any.
+ */
+static void waiting_buffer_resolve(void) {
+    if (IS_TAPPING_PRESSED() && tapping_key.tap.count == 0) {
+        debug("OVERFLOW: Tapping: End. No tap. Waiting buffer full\n");
+        process_record(&tapping_key);
+        tapping_key = (keyrecord_t){};
+        debug_tapping_key();
+    } else {
+        // not expected to happen, start over as before
+        debug("OVERFLOW: CLEAR ALL STATES\n");
+        clear_keyboard();
+        waiting_buffer_clear();
+        tapping_key = (keyrecord_t){};
+    }
+}
+
 /** \brief Tapping
  *
  * Rule: Tap key is typed(pressed and released) within TAPPING_TERM.
@@ -364,13 +404,17 @@ bool waiting_buffer_enq(keyrecord_t record) {
         return true;
     }
 
-    if ((waiting_buffer_head + 1) % WAITING_BUFFER_SIZE == waiting_buffer_tail) {
+    if (WAITING_BUFFER_NEXT(waiting_buffer_head) == waiting_buffer_tail) {
         debug("waiting_buffer_enq: Over flow.\n");
         return false;
     }
 
     waiting_buffer[waiting_buffer_head] = record;
-    waiting_buffer_head                 = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
+    waiting_buffer_head                 = WAITING_BUFFER_NEXT(waiting_buffer_head);
+    waiting_buffer_keys[record.event.pressed][WAITING_BUFFER_KEY_BUCKET(record.event.key)]++;
+    if (record.event.pressed) {
+        waiting_buffer_pressed++;
+    }
 
     debug("waiting_buffer_enq: ");
     debug_waiting_buffer();
@@ -382,8 +426,24 @@ bool waiting_buffer_enq(keyrecord_t record) {
  * FIXME: Needs docs
  */
 void waiting_buffer_clear(void) {
-    waiting_buffer_head = 0;
-    waiting_buffer_tail = 0;
+    waiting_buffer_head    = 0;
+    waiting_buffer_tail    = 0;
+    waiting_buffer_pressed = 0;
+    memset(waiting_buffer_keys, 0, sizeof(waiting_buffer_keys));
+}
+
+/** \brief Waiting buffer deq
+ *
+ * Removes the oldest event.
+ */
+static void waiting_buffer_deq(void) {
+    keyevent_t event = waiting_buffer[waiting_buffer_tail].event;
+
+    waiting_buffer_keys[event.pressed][WAITING_BUFFER_KEY_BUCKET(event.key)]--;
+    if (event.pressed) {
+        waiting_buffer_pressed--;
+    }
+    waiting_buffer_tail = WAITING_BUFFER_NEXT(waiting_buffer_tail);
 }
 
 /** \brief Waiting buffer typed
@@ -391,7 +451,10 @@ void waiting_buffer_clear(void) {
  * FIXME: Needs docs
  */
 bool waiting_buffer_typed(keyevent_t event) {
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+    if (!waiting_buffer_keys[!event.pressed][WAITING_BUFFER_KEY_BUCKET(event.key)]) {
+        return false;
+    }
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = WAITING_BUFFER_NEXT(i)) {
         if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed != waiting_buffer[i].event.pressed) {
             return true;
         }
@@ -403,12 +466,7 @@ bool waiting_buffer_typed(keyevent_t event) {
  *
  * FIXME: Needs docs
  */
-__attribute__((unused)) bool waiting_buffer_has_anykey_pressed(void) {
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (waiting_buffer[i].event.pressed) return true;
-    }
-    return false;
-}
+__attribute__((unused)) bool waiting_buffer_has_anykey_pressed(void) { return waiting_buffer_pressed > 0; }
 
 /** \brief Scan buffer for tapping
  *
@@ -419,8 +477,10 @@ void waiting_buffer_scan_tap(void) {
     if (tapping_key.tap.count > 0) return;
     // invalid state: tapping_key released && tap.count == 0
     if (!tapping_key.event.pressed) return;
+    // no release of the tapping key buffered
+    if (!waiting_buffer_keys[false][WAITING_BUFFER_KEY_BUCKET(tapping_key.event.key)]) return;
 
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = WAITING_BUFFER_NEXT(i)) {
         if (IS_TAPPING_KEY(waiting_buffer[i].event.key) && !waiting_buffer[i].event.pressed && WITHIN_TAPPING_TERM(waiting_buffer[i].event)) {
             tapping_key.tap.count       = 1;
             waiting_buffer[i].tap.count = 1;
@@ -451,7 +511,7 @@ static void debug_tapping_key(void) {
  */
 static void debug_waiting_buffer(void) {
     debug("{ ");
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = WAITING_BUFFER_NEXT(i)) {
         debug("[");
         debug_dec(i);
         debug("]=");
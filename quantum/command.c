@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "command.h"
 #include "quantum.h"
 #include "version.h"
+#include "latency_probe.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -440,6 +441,9 @@ static bool command_common(uint8_t code) {
         // print status
         case MAGIC_KC(MAGIC_KEY_STATUS):
             print_status();
+#ifdef LATENCY_PROBE_ENABLE
+            latency_probe_print();
+#endif
             break;
 
 #ifdef NKRO_ENABLE
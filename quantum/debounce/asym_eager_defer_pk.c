@@ -18,20 +18,15 @@
  */
 
 /*
-Basic symmetric per-key algorithm. Uses an 8-bit counter per key.
+Basic symmetric per-key algorithm. Uses a bit-sliced counter per key, see bitslice.h.
 When no state changes have occured for DEBOUNCE milliseconds, we push the state.
 */
 
 #include "matrix.h"
 #include "timer.h"
 #include "quantum.h"
-#include <stdlib.h>
-
-#ifdef PROTOCOL_CHIBIOS
-#    if CH_CFG_USE_MEMCORE == FALSE
-#        error ChibiOS is configured without a memory allocator. Your keyboard may have set `#define CH_CFG_USE_MEMCORE FALSE`, which is incompatible with this debounce algorithm.
-#    endif
-#endif
+#include "timebase.h"
+#include <string.h>
 
 #ifndef DEBOUNCE
 #    define DEBOUNCE 5
@@ -43,52 +38,40 @@ When no state changes have occured for DEBOUNCE milliseconds, we push the state.
 #    define DEBOUNCE 127
 #endif
 
-#define ROW_SHIFTER ((matrix_row_t)1)
+#include "bitslice.h"
 
 typedef struct {
-    bool    pressed : 1;
-    uint8_t time : 7;
+    debounce_counter_row_t time;
+    matrix_row_t           pressed;  // direction of the change being debounced
 } debounce_counter_t;
 
 #if DEBOUNCE > 0
-static debounce_counter_t *debounce_counters;
-static fast_timer_t        last_time;
+static debounce_counter_t  debounce_counters[MATRIX_ROWS];
+static debounce_row_list_t debounce_rows;  // rows with running counters
+static debounce_time_t     last_time;
 static bool                counters_need_update;
 static bool                matrix_need_update;
 
-#    define DEBOUNCE_ELAPSED 0
-
 static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time);
 static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
 
 // we use num_rows rather than MATRIX_ROWS to support split keyboards
 void debounce_init(uint8_t num_rows) {
-    debounce_counters = malloc(num_rows * MATRIX_COLS * sizeof(debounce_counter_t));
-    int i             = 0;
-    for (uint8_t r = 0; r < num_rows; r++) {
-        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
-            debounce_counters[i++].time = DEBOUNCE_ELAPSED;
-        }
-    }
+    memset(debounce_counters, 0, sizeof(debounce_counters));
+    debounce_rows.count  = 0;
+    counters_need_update = false;
+    matrix_need_update   = false;
 }
 
-void debounce_free(void) {
-    free(debounce_counters);
-    debounce_counters = NULL;
-}
+void debounce_free(void) {}
 
 void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
     bool updated_last = false;
 
     if (counters_need_update) {
-        fast_timer_t now          = timer_read_fast();
-        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+        uint8_t elapsed_time = debounce_time_elapse(&last_time);
 
-        last_time    = now;
         updated_last = true;
-        if (elapsed_time > UINT8_MAX) {
-            elapsed_time = UINT8_MAX;
-        }
 
         if (elapsed_time > 0) {
             update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, elapsed_time);
@@ -97,7 +80,7 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 
     if (changed || matrix_need_update) {
         if (!updated_last) {
-            last_time = timer_read_fast();
+            last_time = debounce_time_read();
         }
 
         transfer_matrix_values(raw, cooked, num_rows);
@@ -105,64 +88,59 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 }
 
 static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
-    debounce_counter_t *debounce_pointer = debounce_counters;
+    for (uint8_t i = 0; i < debounce_rows.count;) {
+        uint8_t             row     = debounce_rows.rows[i];
+        debounce_counter_t *counter = &debounce_counters[row];
+        matrix_row_t        expired = debounce_counters_elapse(&counter->time, elapsed_time);
+
+        if (expired & counter->pressed) {
+            // key-down: eager
+            matrix_need_update = true;
+        }
 
-    counters_need_update = false;
-    matrix_need_update   = false;
+        // key-up: defer
+        expired &= ~counter->pressed;
+        cooked[row] = (cooked[row] & ~expired) | (raw[row] & expired);
 
-    for (uint8_t row = 0; row < num_rows; row++) {
-        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-            matrix_row_t col_mask = (ROW_SHIFTER << col);
-
-            if (debounce_pointer->time != DEBOUNCE_ELAPSED) {
-                if (debounce_pointer->time <= elapsed_time) {
-                    debounce_pointer->time = DEBOUNCE_ELAPSED;
-
-                    if (debounce_pointer->pressed) {
-                        // key-down: eager
-                        matrix_need_update = true;
-                    } else {
-                        // key-up: defer
-                        cooked[row] = (cooked[row] & ~col_mask) | (raw[row] & col_mask);
-                    }
-                } else {
-                    debounce_pointer->time -= elapsed_time;
-                    counters_need_update = true;
-                }
-            }
-            debounce_pointer++;
+        if (debounce_counters_active(&counter->time)) {
+            i++;
+        } else {
+            debounce_row_list_remove_at(&debounce_rows, i);
         }
     }
+    counters_need_update = debounce_rows.count > 0;
 }
 
 static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
-    debounce_counter_t *debounce_pointer = debounce_counters;
+    matrix_need_update = false;
 
     for (uint8_t row = 0; row < num_rows; row++) {
-        matrix_row_t delta = raw[row] ^ cooked[row];
-        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-            matrix_row_t col_mask = (ROW_SHIFTER << col);
-
-            if (delta & col_mask) {
-                if (debounce_pointer->time == DEBOUNCE_ELAPSED) {
-                    debounce_pointer->pressed = (raw[row] & col_mask);
-                    debounce_pointer->time    = DEBOUNCE;
-                    counters_need_update      = true;
-
-                    if (debounce_pointer->pressed) {
-                        // key-down: eager
-                        cooked[row] ^= col_mask;
-                    }
-                }
-            } else if (debounce_pointer->time != DEBOUNCE_ELAPSED) {
-                if (!debounce_pointer->pressed) {
-                    // key-up: defer
-                    debounce_pointer->time = DEBOUNCE_ELAPSED;
-                }
+        debounce_counter_t *counter = &debounce_counters[row];
+        matrix_row_t        delta   = raw[row] ^ cooked[row];
+        matrix_row_t        active  = debounce_counters_active(&counter->time);
+        matrix_row_t        start   = delta & ~active;
+
+        if (start) {
+            counter->pressed = (counter->pressed & ~start) | (raw[row] & start);
+            debounce_counters_start(&counter->time, start);
+            if (!active) {
+                debounce_row_list_add(&debounce_rows, row);
+            }
+
+            // key-down: eager
+            cooked[row] ^= start & raw[row];
+        }
+
+        // key-up: defer
+        matrix_row_t cancel = ~delta & active & ~counter->pressed;
+        if (cancel) {
+            debounce_counters_clear(&counter->time, cancel);
+            if (!debounce_counters_active(&counter->time)) {
+                debounce_row_list_remove(&debounce_rows, row);
             }
-            debounce_pointer++;
         }
     }
+    counters_need_update = debounce_rows.count > 0;
 }
 
 bool debounce_active(void) { return true; }
@@ -0,0 +1,136 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Bit-sliced debounce counters for the per-key algorithms.
+
+The counters of a row are stored as bit-planes: bit n of the counter of the key in column c is
+bit c of plane n. Every operation on a row is then a handful of bitwise operations on
+matrix_row_t, however many keys in the row are bouncing. A counter of 0 means elapsed.
+
+Rows with running counters are kept in a debounce_row_list_t, so that counting down only visits
+the rows where keys are actually bouncing.
+*/
+
+#pragma once
+
+#include "matrix.h"
+
+#if DEBOUNCE < 2
+#    define DEBOUNCE_COUNTER_BITS 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_COUNTER_BITS 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_COUNTER_BITS 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_COUNTER_BITS 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_COUNTER_BITS 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_COUNTER_BITS 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_COUNTER_BITS 7
+#else
+#    define DEBOUNCE_COUNTER_BITS 8
+#endif
+
+typedef struct {
+    matrix_row_t bit[DEBOUNCE_COUNTER_BITS];
+} debounce_counter_row_t;
+
+/* Returns the keys whose counters are running. */
+static inline matrix_row_t debounce_counters_active(const debounce_counter_row_t *counters) {
+    matrix_row_t active = 0;
+    for (uint8_t i = 0; i < DEBOUNCE_COUNTER_BITS; i++) {
+        active |= counters->bit[i];
+    }
+    return active;
+}
+
+/* Sets the counters of keys to DEBOUNCE. */
+static inline void debounce_counters_start(debounce_counter_row_t *counters, matrix_row_t keys) {
+    for (uint8_t i = 0; i < DEBOUNCE_COUNTER_BITS; i++) {
+        if (DEBOUNCE & (1 << i)) {
+            counters->bit[i] |= keys;
+        } else {
+            counters->bit[i] &= ~keys;
+        }
+    }
+}
+
+/* Sets the counters of keys to elapsed. */
+static inline void debounce_counters_clear(debounce_counter_row_t *counters, matrix_row_t keys) {
+    for (uint8_t i = 0; i < DEBOUNCE_COUNTER_BITS; i++) {
+        counters->bit[i] &= ~keys;
+    }
+}
+
+/* Counts the running counters down by elapsed_time, stopping at 0.
+ *
+ * Returns the keys whose counters have just elapsed.
+ */
+static inline matrix_row_t debounce_counters_elapse(debounce_counter_row_t *counters, uint8_t elapsed_time) {
+    matrix_row_t active = debounce_counters_active(counters);
+    matrix_row_t borrow = 0;
+
+    if (!active) {
+        return 0;
+    }
+
+    if (elapsed_time >> DEBOUNCE_COUNTER_BITS) {
+        // longer than any counter runs
+        debounce_counters_clear(counters, active);
+        return active;
+    }
+
+    // ripple-borrow subtraction, one plane at a time
+    for (uint8_t i = 0; i < DEBOUNCE_COUNTER_BITS; i++) {
+        matrix_row_t plane = counters->bit[i];
+        if (elapsed_time & (1 << i)) {
+            counters->bit[i] = ~(plane ^ borrow);
+            borrow           = ~plane | borrow;
+        } else {
+            counters->bit[i] = plane ^ borrow;
+            borrow           = ~plane & borrow;
+        }
+    }
+
+    // a borrow out of the top plane means the counter was below elapsed_time
+    matrix_row_t expired = active & (borrow | ~debounce_counters_active(counters));
+    for (uint8_t i = 0; i < DEBOUNCE_COUNTER_BITS; i++) {
+        counters->bit[i] &= active & ~expired;
+    }
+    return expired;
+}
+
+typedef struct {
+    uint8_t count;
+    uint8_t rows[MATRIX_ROWS];
+} debounce_row_list_t;
+
+static inline void debounce_row_list_add(debounce_row_list_t *list, uint8_t row) { list->rows[list->count++] = row; }
+
+/* Removes the entry at index, the last entry takes its place. */
+static inline void debounce_row_list_remove_at(debounce_row_list_t *list, uint8_t index) { list->rows[index] = list->rows[--list->count]; }
+
+static inline void debounce_row_list_remove(debounce_row_list_t *list, uint8_t row) {
+    for (uint8_t i = 0; i < list->count; i++) {
+        if (list->rows[i] == row) {
+            debounce_row_list_remove_at(list, i);
+            return;
+        }
+    }
+}
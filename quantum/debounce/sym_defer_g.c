@@ -20,23 +20,24 @@ When no state changes have occured for DEBOUNCE milliseconds, we push the state.
 #include "matrix.h"
 #include "timer.h"
 #include "quantum.h"
+#include "timebase.h"
 #ifndef DEBOUNCE
 #    define DEBOUNCE 5
 #endif
 
 #if DEBOUNCE > 0
-static bool         debouncing = false;
-static fast_timer_t debouncing_time;
+static bool            debouncing = false;
+static debounce_time_t debouncing_time;
 
 void debounce_init(uint8_t num_rows) {}
 
 void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
     if (changed) {
         debouncing      = true;
-        debouncing_time = timer_read_fast();
+        debouncing_time = debounce_time_read();
     }
 
-    if (debouncing && timer_elapsed_fast(debouncing_time) >= DEBOUNCE) {
+    if (debouncing && debounce_time_elapsed(debouncing_time) >= DEBOUNCE) {
         for (int i = 0; i < num_rows; i++) {
             cooked[i] = raw[i];
         }
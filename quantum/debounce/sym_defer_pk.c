@@ -15,20 +15,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 /*
-Basic symmetric per-key algorithm. Uses an 8-bit counter per key.
+Basic symmetric per-key algorithm. Uses a bit-sliced counter per key, see bitslice.h.
 When no state changes have occured for DEBOUNCE milliseconds, we push the state.
 */
 
 #include "matrix.h"
 #include "timer.h"
 #include "quantum.h"
-#include <stdlib.h>
-
-#ifdef PROTOCOL_CHIBIOS
-#    if CH_CFG_USE_MEMCORE == FALSE
-#        error ChibiOS is configured without a memory allocator. Your keyboard may have set `#define CH_CFG_USE_MEMCORE FALSE`, which is incompatible with this debounce algorithm.
-#    endif
-#endif
+#include "timebase.h"
+#include <string.h>
 
 #ifndef DEBOUNCE
 #    define DEBOUNCE 5
@@ -40,48 +35,33 @@ When no state changes have occured for DEBOUNCE milliseconds, we push the state.
 #    define DEBOUNCE UINT8_MAX
 #endif
 
-#define ROW_SHIFTER ((matrix_row_t)1)
-
-typedef uint8_t debounce_counter_t;
+#include "bitslice.h"
 
 #if DEBOUNCE > 0
-static debounce_counter_t *debounce_counters;
-static fast_timer_t        last_time;
-static bool                counters_need_update;
-
-#    define DEBOUNCE_ELAPSED 0
+static debounce_counter_row_t debounce_counters[MATRIX_ROWS];
+static debounce_row_list_t    debounce_rows;  // rows with running counters
+static debounce_time_t        last_time;
+static bool                   counters_need_update;
 
 static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time);
 static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
 
 // we use num_rows rather than MATRIX_ROWS to support split keyboards
 void debounce_init(uint8_t num_rows) {
-    debounce_counters = (debounce_counter_t *)malloc(num_rows * MATRIX_COLS * sizeof(debounce_counter_t));
-    int i             = 0;
-    for (uint8_t r = 0; r < num_rows; r++) {
-        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
-            debounce_counters[i++] = DEBOUNCE_ELAPSED;
-        }
-    }
+    memset(debounce_counters, 0, sizeof(debounce_counters));
+    debounce_rows.count  = 0;
+    counters_need_update = false;
 }
 
-void debounce_free(void) {
-    free(debounce_counters);
-    debounce_counters = NULL;
-}
+void debounce_free(void) {}
 
 void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
     bool updated_last = false;
 
     if (counters_need_update) {
-        fast_timer_t now          = timer_read_fast();
-        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+        uint8_t elapsed_time = debounce_time_elapse(&last_time);
 
-        last_time    = now;
         updated_last = true;
-        if (elapsed_time > UINT8_MAX) {
-            elapsed_time = UINT8_MAX;
-        }
 
         if (elapsed_time > 0) {
             update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, elapsed_time);
@@ -90,7 +70,7 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 
     if (changed) {
         if (!updated_last) {
-            last_time = timer_read_fast();
+            last_time = debounce_time_read();
         }
 
         start_debounce_counters(raw, cooked, num_rows);
@@ -98,40 +78,41 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 }
 
 static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
-    counters_need_update                 = false;
-    debounce_counter_t *debounce_pointer = debounce_counters;
-    for (uint8_t row = 0; row < num_rows; row++) {
-        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-            if (*debounce_pointer != DEBOUNCE_ELAPSED) {
-                if (*debounce_pointer <= elapsed_time) {
-                    *debounce_pointer = DEBOUNCE_ELAPSED;
-                    cooked[row]       = (cooked[row] & ~(ROW_SHIFTER << col)) | (raw[row] & (ROW_SHIFTER << col));
-                } else {
-                    *debounce_pointer -= elapsed_time;
-                    counters_need_update = true;
-                }
-            }
-            debounce_pointer++;
+    for (uint8_t i = 0; i < debounce_rows.count;) {
+        uint8_t      row     = debounce_rows.rows[i];
+        matrix_row_t expired = debounce_counters_elapse(&debounce_counters[row], elapsed_time);
+
+        cooked[row] = (cooked[row] & ~expired) | (raw[row] & expired);
+        if (debounce_counters_active(&debounce_counters[row])) {
+            i++;
+        } else {
+            debounce_row_list_remove_at(&debounce_rows, i);
         }
     }
+    counters_need_update = debounce_rows.count > 0;
 }
 
 static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
-    debounce_counter_t *debounce_pointer = debounce_counters;
     for (uint8_t row = 0; row < num_rows; row++) {
-        matrix_row_t delta = raw[row] ^ cooked[row];
-        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-            if (delta & (ROW_SHIFTER << col)) {
-                if (*debounce_pointer == DEBOUNCE_ELAPSED) {
-                    *debounce_pointer    = DEBOUNCE;
-                    counters_need_update = true;
-                }
-            } else {
-                *debounce_pointer = DEBOUNCE_ELAPSED;
+        matrix_row_t delta  = raw[row] ^ cooked[row];
+        matrix_row_t active = debounce_counters_active(&debounce_counters[row]);
+
+        if (active & ~delta) {
+            // back to the debounced state before the counter ran out
+            debounce_counters_clear(&debounce_counters[row], ~delta);
+            active &= delta;
+            if (!active) {
+                debounce_row_list_remove(&debounce_rows, row);
+            }
+        }
+        if (delta & ~active) {
+            debounce_counters_start(&debounce_counters[row], delta & ~active);
+            if (!active) {
+                debounce_row_list_add(&debounce_rows, row);
             }
-            debounce_pointer++;
         }
     }
+    counters_need_update = debounce_rows.count > 0;
 }
 
 bool debounce_active(void) { return true; }
@@ -14,7 +14,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 /*
-Basic per-key algorithm. Uses an 8-bit counter per key.
+Basic per-key algorithm. Uses a bit-sliced counter per key, see bitslice.h.
 After pressing a key, it immediately changes state, and sets a counter.
 No further inputs are accepted until DEBOUNCE milliseconds have occurred.
 */
@@ -22,13 +22,8 @@ No further inputs are accepted until DEBOUNCE milliseconds have occurred.
 #include "matrix.h"
 #include "timer.h"
 #include "quantum.h"
-#include <stdlib.h>
-
-#ifdef PROTOCOL_CHIBIOS
-#    if CH_CFG_USE_MEMCORE == FALSE
-#        error ChibiOS is configured without a memory allocator. Your keyboard may have set `#define CH_CFG_USE_MEMCORE FALSE`, which is incompatible with this debounce algorithm.
-#    endif
-#endif
+#include "timebase.h"
+#include <string.h>
 
 #ifndef DEBOUNCE
 #    define DEBOUNCE 5
@@ -40,49 +35,35 @@ No further inputs are accepted until DEBOUNCE milliseconds have occurred.
 #    define DEBOUNCE UINT8_MAX
 #endif
 
-#define ROW_SHIFTER ((matrix_row_t)1)
-
-typedef uint8_t debounce_counter_t;
+#include "bitslice.h"
 
 #if DEBOUNCE > 0
-static debounce_counter_t *debounce_counters;
-static fast_timer_t        last_time;
-static bool                counters_need_update;
-static bool                matrix_need_update;
-
-#    define DEBOUNCE_ELAPSED 0
+static debounce_counter_row_t debounce_counters[MATRIX_ROWS];
+static debounce_row_list_t    debounce_rows;  // rows with running counters
+static debounce_time_t        last_time;
+static bool                   counters_need_update;
+static bool                   matrix_need_update;
 
 static void update_debounce_counters(uint8_t num_rows, uint8_t elapsed_time);
 static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
 
 // we use num_rows rather than MATRIX_ROWS to support split keyboards
 void debounce_init(uint8_t num_rows) {
-    debounce_counters = (debounce_counter_t *)malloc(num_rows * MATRIX_COLS * sizeof(debounce_counter_t));
-    int i             = 0;
-    for (uint8_t r = 0; r < num_rows; r++) {
-        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
-            debounce_counters[i++] = DEBOUNCE_ELAPSED;
-        }
-    }
+    memset(debounce_counters, 0, sizeof(debounce_counters));
+    debounce_rows.count  = 0;
+    counters_need_update = false;
+    matrix_need_update   = false;
 }
 
-void debounce_free(void) {
-    free(debounce_counters);
-    debounce_counters = NULL;
-}
+void debounce_free(void) {}
 
 void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
     bool updated_last = false;
 
     if (counters_need_update) {
-        fast_timer_t now          = timer_read_fast();
-        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+        uint8_t elapsed_time = debounce_time_elapse(&last_time);
 
-        last_time    = now;
         updated_last = true;
-        if (elapsed_time > UINT8_MAX) {
-            elapsed_time = UINT8_MAX;
-        }
 
         if (elapsed_time > 0) {
             update_debounce_counters(num_rows, elapsed_time);
@@ -91,7 +72,7 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 
     if (changed || matrix_need_update) {
         if (!updated_last) {
-            last_time = timer_read_fast();
+            last_time = debounce_time_read();
         }
 
         transfer_matrix_values(raw, cooked, num_rows);
@@ -100,43 +81,36 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 
 // If the current time is > debounce counter, set the counter to enable input.
 static void update_debounce_counters(uint8_t num_rows, uint8_t elapsed_time) {
-    counters_need_update                 = false;
-    matrix_need_update                   = false;
-    debounce_counter_t *debounce_pointer = debounce_counters;
-    for (uint8_t row = 0; row < num_rows; row++) {
-        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-            if (*debounce_pointer != DEBOUNCE_ELAPSED) {
-                if (*debounce_pointer <= elapsed_time) {
-                    *debounce_pointer  = DEBOUNCE_ELAPSED;
-                    matrix_need_update = true;
-                } else {
-                    *debounce_pointer -= elapsed_time;
-                    counters_need_update = true;
-                }
-            }
-            debounce_pointer++;
+    for (uint8_t i = 0; i < debounce_rows.count;) {
+        uint8_t row = debounce_rows.rows[i];
+
+        if (debounce_counters_elapse(&debounce_counters[row], elapsed_time)) {
+            matrix_need_update = true;
+        }
+        if (debounce_counters_active(&debounce_counters[row])) {
+            i++;
+        } else {
+            debounce_row_list_remove_at(&debounce_rows, i);
         }
     }
+    counters_need_update = debounce_rows.count > 0;
 }
 
 // upload from raw_matrix to final matrix;
 static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
-    debounce_counter_t *debounce_pointer = debounce_counters;
+    matrix_need_update = false;
     for (uint8_t row = 0; row < num_rows; row++) {
-        matrix_row_t delta        = raw[row] ^ cooked[row];
-        matrix_row_t existing_row = cooked[row];
-        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-            matrix_row_t col_mask = (ROW_SHIFTER << col);
-            if (delta & col_mask) {
-                if (*debounce_pointer == DEBOUNCE_ELAPSED) {
-                    *debounce_pointer    = DEBOUNCE;
-                    counters_need_update = true;
-                    existing_row ^= col_mask;  // flip the bit.
-                }
+        matrix_row_t active = debounce_counters_active(&debounce_counters[row]);
+        matrix_row_t flip   = (raw[row] ^ cooked[row]) & ~active;
+
+        if (flip) {
+            debounce_counters_start(&debounce_counters[row], flip);
+            if (!active) {
+                debounce_row_list_add(&debounce_rows, row);
             }
-            debounce_pointer++;
+            counters_need_update = true;
+            cooked[row] ^= flip;
         }
-        cooked[row] = existing_row;
     }
 }
 
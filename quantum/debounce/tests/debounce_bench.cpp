@@ -0,0 +1,158 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCH_CYCLES() __rdtsc()
+#endif
+
+extern "C" {
+#include "quantum.h"
+#include "timer.h"
+#include "debounce.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+// Measures the time debounce() takes per matrix scan, for a few kinds of input. Scans run at
+// 10kHz of virtual time. ns/scan covers the whole loop, cycles/scan (x86 hosts only) just the
+// debounce() calls. The results are printed, there is nothing to pass or fail except that every
+// key still ends up in the state it was left in.
+
+#ifndef BENCH_SCANS
+#    define BENCH_SCANS 200000
+#endif
+#define SCANS_PER_MS 10
+
+class DebounceBench : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        debounce_init(MATRIX_ROWS);
+        set_time(7777);
+        std::fill(std::begin(raw_), std::end(raw_), 0);
+        std::fill(std::begin(cooked_), std::end(cooked_), 0);
+    }
+
+    void TearDown() override { debounce_free(); }
+
+    /* Calls input() before every scan, it returns whether it changed the raw matrix. */
+    void run(const char *name, std::function<bool(uint32_t scan)> input) {
+        uint64_t cycles = 0;
+        auto     start  = std::chrono::steady_clock::now();
+
+        for (uint32_t scan = 0; scan < BENCH_SCANS; scan++) {
+            bool changed = input(scan);
+#ifdef BENCH_CYCLES
+            uint64_t before = BENCH_CYCLES();
+            debounce(raw_, cooked_, MATRIX_ROWS, changed);
+            cycles += BENCH_CYCLES() - before;
+#else
+            debounce(raw_, cooked_, MATRIX_ROWS, changed);
+#endif
+            if (scan % SCANS_PER_MS == SCANS_PER_MS - 1) {
+                advance_time(1);
+            }
+        }
+
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        printf("%-8s %8.1f ns/scan", name, ns / BENCH_SCANS);
+#ifdef BENCH_CYCLES
+        printf(" %8.1f cycles/scan", (double)cycles / BENCH_SCANS - overhead());
+#endif
+        printf("\n");
+
+        settle();
+    }
+
+    /* Let everything settle, the cooked matrix must then match the raw matrix. */
+    void settle() {
+        for (int i = 0; i < 1000; i++) {
+            debounce(raw_, cooked_, MATRIX_ROWS, i == 0);
+            advance_time(1);
+        }
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            EXPECT_EQ(raw_[row], cooked_[row]) << "row " << (int)row;
+        }
+    }
+
+#ifdef BENCH_CYCLES
+    /* Cycles taken by reading the cycle counter itself. */
+    static double overhead() {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 1000; i++) {
+            uint64_t before = BENCH_CYCLES();
+            best            = std::min<uint64_t>(best, BENCH_CYCLES() - before);
+        }
+        return best;
+    }
+#endif
+
+    void toggle(uint8_t row, uint8_t col) { raw_[row] ^= (matrix_row_t)1 << col; }
+
+    uint32_t random() {
+        seed_ = seed_ * 1103515245 + 12345;
+        return seed_ >> 8;
+    }
+
+    matrix_row_t raw_[MATRIX_ROWS];
+    matrix_row_t cooked_[MATRIX_ROWS];
+    uint32_t     seed_ = 1;
+};
+
+TEST_F(DebounceBench, Idle) {
+    run("idle", [](uint32_t scan) { return false; });
+}
+
+TEST_F(DebounceBench, Held) {
+    raw_[0] = raw_[MATRIX_ROWS - 1] = 0x5;
+    settle();
+    run("held", [](uint32_t scan) { return false; });
+}
+
+/* A key changes every 50ms and bounces for the first 1ms. */
+TEST_F(DebounceBench, Typing) {
+    uint8_t row = 0, col = 0;
+    run("typing", [&](uint32_t scan) {
+        uint32_t phase = scan % (50 * SCANS_PER_MS);
+        if (phase == 0) {
+            row = random() % MATRIX_ROWS;
+            col = random() % MATRIX_COLS;
+        }
+        if (phase < 4) {
+            toggle(row, col);
+            return true;
+        }
+        return false;
+    });
+}
+
+/* A few keys change on every scan. */
+TEST_F(DebounceBench, Chatter) {
+    run("chatter", [&](uint32_t scan) {
+        for (int i = 0; i < 4; i++) {
+            toggle(random() % MATRIX_ROWS, random() % MATRIX_COLS);
+        }
+        return true;
+    });
+}
@@ -28,9 +28,24 @@ extern "C" {
 #include "debounce.h"
 
 void set_time(uint32_t t);
+void set_time_us(uint32_t t);
 void advance_time(uint32_t ms);
+void advance_time_us(uint32_t us);
 }
 
+#ifdef DEBOUNCE_US
+/* Event times count in steps of DEBOUNCE_STEP_US, between events time moves on a microsecond at a time */
+static uint32_t test_time_read(void) { return timer_read_us() / DEBOUNCE_STEP_US; }
+static void     test_time_set(uint32_t t) { set_time_us(t * DEBOUNCE_STEP_US); }
+static void     test_time_advance(void) { advance_time_us(DEBOUNCE_STEP_US); }
+static void     test_time_advance_scan(void) { advance_time_us(1); }
+#else
+static fast_timer_t test_time_read(void) { return timer_read_fast(); }
+static void         test_time_set(uint32_t t) { set_time(t); }
+static void         test_time_advance(void) { advance_time(1); }
+static void         test_time_advance_scan(void) { advance_time(1); }
+#endif
+
 void DebounceTest::addEvents(std::initializer_list<DebounceTestEvent> events) { events_.insert(events_.end(), events.begin(), events.end()); }
 
 void DebounceTest::runEvents() {
@@ -56,25 +71,25 @@ void DebounceTest::runEventsInternal() {
 
     /* Initialise keyboard with start time (offset to avoid testing at 0) and all keys UP */
     debounce_init(MATRIX_ROWS);
-    set_time(time_offset_);
+    test_time_set(time_offset_);
     std::fill(std::begin(input_matrix_), std::end(input_matrix_), 0);
     std::fill(std::begin(output_matrix_), std::end(output_matrix_), 0);
 
     for (auto &event : events_) {
         if (!auto_advance_time_) {
             /* Jump to the next event */
-            set_time(time_offset_ + event.time_);
+            test_time_set(time_offset_ + event.time_);
         } else if (!first && event.time_ == previous + 1) {
             /* This event immediately follows the previous one, don't make extra debounce() calls */
-            advance_time(1);
+            test_time_advance();
         } else {
             /* Fast forward to the time for this event, calling debounce() with no changes */
-            ASSERT_LT((time_offset_ + event.time_) - timer_read_fast(), 60000) << "Test tries to advance more than 1 minute of time";
+            ASSERT_LT((time_offset_ + event.time_) - test_time_read(), 60000) << "Test tries to advance more than 1 minute of time";
 
-            while (timer_read_fast() != time_offset_ + event.time_) {
+            while (test_time_read() != time_offset_ + event.time_) {
                 runDebounce(false);
                 checkCookedMatrix(false, "debounce() modified cooked matrix");
-                advance_time(1);
+                test_time_advance_scan();
             }
         }
 
@@ -113,7 +128,7 @@ void DebounceTest::runEventsInternal() {
     for (int i = 0; i < 60000; i++) {
         runDebounce(false);
         checkCookedMatrix(false, "debounce() modified cooked matrix");
-        advance_time(1);
+        test_time_advance();
     }
 
     debounce_free();
@@ -139,7 +154,7 @@ void DebounceTest::checkCookedMatrix(bool changed, const std::string &error_mess
 std::string DebounceTest::strTime() {
     std::stringstream text;
 
-    text << "time " << (timer_read_fast() - time_offset_) << " (extra_iterations=" << extra_iterations_ << ", auto_advance_time=" << auto_advance_time_ << ")";
+    text << "time " << (test_time_read() - time_offset_) << " (extra_iterations=" << extra_iterations_ << ", auto_advance_time=" << auto_advance_time_ << ")";
 
     return text.str();
 }
@@ -42,3 +42,42 @@ debounce_asym_eager_defer_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
 debounce_asym_eager_defer_pk_SRC := $(DEBOUNCE_COMMON_SRC) \
 	$(QUANTUM_PATH)/debounce/asym_eager_defer_pk.c \
 	$(QUANTUM_PATH)/debounce/tests/asym_eager_defer_pk_tests.cpp
+
+# The same tests again, with the debounce time in microseconds: 5 steps of 4us
+DEBOUNCE_US_DEFS := -DMATRIX_ROWS=4 -DMATRIX_COLS=10 -DDEBOUNCE_US=20 -DDEBOUNCE_STEP_US=4
+
+debounce_sym_defer_g_us_DEFS := $(DEBOUNCE_US_DEFS)
+debounce_sym_defer_g_us_SRC := $(debounce_sym_defer_g_SRC)
+
+debounce_sym_defer_pk_us_DEFS := $(DEBOUNCE_US_DEFS)
+debounce_sym_defer_pk_us_SRC := $(debounce_sym_defer_pk_SRC)
+
+debounce_sym_eager_pk_us_DEFS := $(DEBOUNCE_US_DEFS)
+debounce_sym_eager_pk_us_SRC := $(debounce_sym_eager_pk_SRC)
+
+debounce_sym_eager_pr_us_DEFS := $(DEBOUNCE_US_DEFS)
+debounce_sym_eager_pr_us_SRC := $(debounce_sym_eager_pr_SRC)
+
+debounce_asym_eager_defer_pk_us_DEFS := $(DEBOUNCE_US_DEFS)
+debounce_asym_eager_defer_pk_us_SRC := $(debounce_asym_eager_defer_pk_SRC)
+
+DEBOUNCE_BENCH_DEFS := -DMATRIX_ROWS=12 -DMATRIX_COLS=18 -DDEBOUNCE=5
+
+DEBOUNCE_BENCH_SRC := $(QUANTUM_PATH)/debounce/tests/debounce_bench.cpp \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_bench_sym_defer_g_DEFS := $(DEBOUNCE_BENCH_DEFS)
+debounce_bench_sym_defer_g_SRC := $(DEBOUNCE_BENCH_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_defer_g.c
+
+debounce_bench_sym_defer_pk_DEFS := $(DEBOUNCE_BENCH_DEFS)
+debounce_bench_sym_defer_pk_SRC := $(DEBOUNCE_BENCH_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_defer_pk.c
+
+debounce_bench_sym_eager_pk_DEFS := $(DEBOUNCE_BENCH_DEFS)
+debounce_bench_sym_eager_pk_SRC := $(DEBOUNCE_BENCH_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_eager_pk.c
+
+debounce_bench_asym_eager_defer_pk_DEFS := $(DEBOUNCE_BENCH_DEFS)
+debounce_bench_asym_eager_defer_pk_SRC := $(DEBOUNCE_BENCH_SRC) \
+	$(QUANTUM_PATH)/debounce/asym_eager_defer_pk.c
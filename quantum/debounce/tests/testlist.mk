@@ -3,4 +3,13 @@ TEST_LIST += \
 	debounce_sym_defer_pk \
 	debounce_sym_eager_pk \
 	debounce_sym_eager_pr \
-	debounce_asym_eager_defer_pk
+	debounce_asym_eager_defer_pk \
+	debounce_sym_defer_g_us \
+	debounce_sym_defer_pk_us \
+	debounce_sym_eager_pk_us \
+	debounce_sym_eager_pr_us \
+	debounce_asym_eager_defer_pk_us \
+	debounce_bench_sym_defer_g \
+	debounce_bench_sym_defer_pk \
+	debounce_bench_sym_eager_pk \
+	debounce_bench_asym_eager_defer_pk
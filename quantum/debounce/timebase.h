@@ -0,0 +1,88 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Timebase of the debounce algorithms.
+
+DEBOUNCE counts in milliseconds. Boards that scan fast enough for that to be too coarse can set
+DEBOUNCE_US instead, the algorithms then read timer_read_us() and count in steps of
+DEBOUNCE_STEP_US microseconds. The step defaults to the smallest power of two that keeps
+DEBOUNCE within 127 steps, so the counters stay as small as in millisecond mode.
+*/
+
+#pragma once
+
+#include "timer.h"
+
+#ifdef DEBOUNCE_US
+#    ifndef DEBOUNCE_STEP_US
+#        if DEBOUNCE_US <= 127
+#            define DEBOUNCE_STEP_US 1
+#        elif DEBOUNCE_US <= 254
+#            define DEBOUNCE_STEP_US 2
+#        elif DEBOUNCE_US <= 508
+#            define DEBOUNCE_STEP_US 4
+#        elif DEBOUNCE_US <= 1016
+#            define DEBOUNCE_STEP_US 8
+#        elif DEBOUNCE_US <= 2032
+#            define DEBOUNCE_STEP_US 16
+#        elif DEBOUNCE_US <= 4064
+#            define DEBOUNCE_STEP_US 32
+#        elif DEBOUNCE_US <= 8128
+#            define DEBOUNCE_STEP_US 64
+#        else
+#            define DEBOUNCE_STEP_US 128
+#        endif
+#    endif
+#    undef DEBOUNCE
+#    define DEBOUNCE ((DEBOUNCE_US + DEBOUNCE_STEP_US - 1) / DEBOUNCE_STEP_US)
+
+typedef uint32_t debounce_time_t;
+#    define debounce_time_read() timer_read_us()
+#else
+typedef fast_timer_t debounce_time_t;
+#    define debounce_time_read() timer_read_fast()
+#endif
+
+/* Returns the steps elapsed since *last, at most UINT8_MAX, and moves *last on by as many. */
+static inline uint8_t debounce_time_elapse(debounce_time_t *last) {
+    debounce_time_t now = debounce_time_read();
+#ifdef DEBOUNCE_US
+    uint32_t elapsed = TIMER_DIFF_32(now, *last) / DEBOUNCE_STEP_US;
+
+    if (elapsed > UINT8_MAX) {
+        *last = now;
+        return UINT8_MAX;
+    }
+    // keep the part of a step that has already passed, it counts towards the next one
+    *last += elapsed * DEBOUNCE_STEP_US;
+    return elapsed;
+#else
+    debounce_time_t elapsed = TIMER_DIFF_FAST(now, *last);
+
+    *last = now;
+    return elapsed > UINT8_MAX ? UINT8_MAX : elapsed;
+#endif
+}
+
+/* Returns the steps elapsed since last. */
+static inline debounce_time_t debounce_time_elapsed(debounce_time_t last) {
+#ifdef DEBOUNCE_US
+    return TIMER_DIFF_32(debounce_time_read(), last) / DEBOUNCE_STEP_US;
+#else
+    return timer_elapsed_fast(last);
+#endif
+}
@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "eeprom.h"
 #include "eeconfig.h"
 #include "action_layer.h"
@@ -23,6 +24,145 @@ void via_eeprom_set_valid(bool valid);
 void eeconfig_init_via(void);
 #endif
 
+_Static_assert(sizeof(eeconfig_t) == EECONFIG_SIZE, "eeconfig_t does not match the eeconfig addresses");
+
+#ifdef EECONFIG_CACHE
+/*
+ * The record is read with a single block read the first time anything asks for it, and
+ * everything after that is served from RAM. Updates only mark the changed span dirty;
+ * eeconfig_commit() writes it back once per pass of the main loop.
+ *
+ * Rather than a bare magic number, the first word then holds EECONFIG_MAGIC_NUMBER xor a
+ * CRC of the rest of the record, so a torn or corrupted write is detected, and a record
+ * written by an older layout can be handed to eeconfig_migrate_kb() instead of wiped.
+ */
+static eeconfig_t eeconfig_cache;
+static bool       eeconfig_loaded;
+static bool       eeconfig_valid;
+static uint8_t    eeconfig_dirty_start = EECONFIG_SIZE;
+static uint8_t    eeconfig_dirty_end;
+
+static uint16_t eeconfig_crc(const eeconfig_t *config) {
+    // CRC-16/CCITT of everything after the magic word
+    const uint8_t *data = (const uint8_t *)config + sizeof(config->magic);
+    uint16_t       crc  = 0xFFFF;
+    for (uint8_t i = sizeof(config->magic); i < sizeof(eeconfig_t); i++) {
+        crc ^= *data++ << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void eeconfig_mark_dirty(uint8_t offset, uint8_t len) {
+    if (offset < eeconfig_dirty_start) eeconfig_dirty_start = offset;
+    if (offset + len > eeconfig_dirty_end) eeconfig_dirty_end = offset + len;
+}
+
+/** \brief Read the eeconfig record back from the EEPROM
+ *
+ * Drops any updates which haven't been committed yet. Needed after the EEPROM was erased
+ * or written without going through eeconfig_update_*().
+ */
+void eeconfig_reload(void) {
+    eeprom_read_block(&eeconfig_cache, EECONFIG_MAGIC, sizeof(eeconfig_cache));
+    eeconfig_loaded      = true;
+    eeconfig_dirty_start = EECONFIG_SIZE;
+    eeconfig_dirty_end   = 0;
+
+    eeconfig_valid = (eeconfig_cache.magic ^ eeconfig_crc(&eeconfig_cache)) == EECONFIG_MAGIC_NUMBER;
+    if (!eeconfig_valid && (eeconfig_cache.magic == EECONFIG_MAGIC_NUMBER || eeconfig_migrate_kb(eeconfig_cache.magic))) {
+        // written before the checksum was added, or converted by the keyboard: keep it
+        eeconfig_valid = true;
+        eeconfig_mark_dirty(0, sizeof(eeconfig_cache.magic));
+    }
+}
+
+static inline void eeconfig_ensure_loaded(void) {
+    if (!eeconfig_loaded) eeconfig_reload();
+}
+
+/** \brief Write back whatever eeconfig updates are still only in RAM
+ *
+ * Called from keyboard_task(), and before anything that would lose RAM.
+ */
+void eeconfig_commit(void) {
+    if (eeconfig_dirty_end <= eeconfig_dirty_start) return;
+
+    // data first, so a power loss in between leaves a record that fails its checksum
+    uint8_t start = eeconfig_dirty_start < sizeof(eeconfig_cache.magic) ? sizeof(eeconfig_cache.magic) : eeconfig_dirty_start;
+    if (eeconfig_dirty_end > start) {
+        eeprom_update_block((uint8_t *)&eeconfig_cache + start, (uint8_t *)(uintptr_t)start, eeconfig_dirty_end - start);
+    }
+    if (eeconfig_valid) {
+        eeconfig_cache.magic = eeconfig_crc(&eeconfig_cache) ^ EECONFIG_MAGIC_NUMBER;
+    }
+    eeprom_update_word(EECONFIG_MAGIC, eeconfig_cache.magic);
+
+    eeconfig_dirty_start = EECONFIG_SIZE;
+    eeconfig_dirty_end   = 0;
+}
+
+void eeconfig_read_block(void *buf, const void *addr, size_t len) {
+    uintptr_t offset = (uintptr_t)addr;
+    if (offset + len > sizeof(eeconfig_cache)) {
+        // outside the record, e.g. a relocated EECONFIG_LED_MATRIX
+        eeprom_read_block(buf, addr, len);
+        return;
+    }
+    eeconfig_ensure_loaded();
+    memcpy(buf, (uint8_t *)&eeconfig_cache + offset, len);
+}
+
+void eeconfig_update_block(const void *buf, void *addr, size_t len) {
+    uintptr_t offset = (uintptr_t)addr;
+    if (offset + len > sizeof(eeconfig_cache)) {
+        eeprom_update_block(buf, addr, len);
+        return;
+    }
+    eeconfig_ensure_loaded();
+    if (memcmp((uint8_t *)&eeconfig_cache + offset, buf, len) == 0) return;
+    memcpy((uint8_t *)&eeconfig_cache + offset, buf, len);
+    eeconfig_mark_dirty(offset, len);
+}
+
+uint8_t eeconfig_read_byte(const uint8_t *addr) {
+    uint8_t value;
+    eeconfig_read_block(&value, addr, sizeof(value));
+    return value;
+}
+
+uint16_t eeconfig_read_word(const uint16_t *addr) {
+    uint16_t value;
+    eeconfig_read_block(&value, addr, sizeof(value));
+    return value;
+}
+
+uint32_t eeconfig_read_dword(const uint32_t *addr) {
+    uint32_t value;
+    eeconfig_read_block(&value, addr, sizeof(value));
+    return value;
+}
+
+void eeconfig_update_byte(uint8_t *addr, uint8_t value) { eeconfig_update_block(&value, addr, sizeof(value)); }
+
+void eeconfig_update_word(uint16_t *addr, uint16_t value) { eeconfig_update_block(&value, addr, sizeof(value)); }
+
+void eeconfig_update_dword(uint32_t *addr, uint32_t value) { eeconfig_update_block(&value, addr, sizeof(value)); }
+#endif
+
+/** \brief Keep an eeconfig record written by another EECONFIG_MAGIC_NUMBER
+ *
+ * Only consulted with EECONFIG_CACHE. `magic` is the magic word as stored, which is the bare
+ * EECONFIG_MAGIC_NUMBER of the firmware that wrote the record if it didn't use the cache;
+ * convert the fields with eeconfig_update_*() and return true to keep the record, or
+ * return false to have it reset.
+ */
+__attribute__((weak)) bool eeconfig_migrate_user(uint16_t magic) { return false; }
+
+__attribute__((weak)) bool eeconfig_migrate_kb(uint16_t magic) { return eeconfig_migrate_user(magic); }
+
 /** \brief eeconfig enable
  *
  * FIXME: needs doc
@@ -49,30 +189,33 @@ void eeconfig_init_quantum(void) {
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
 #endif
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
-    eeprom_update_byte(EECONFIG_DEBUG, 0);
-    eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 0);
+#ifdef EECONFIG_CACHE
+    eeconfig_reload();
+#endif
+    eeconfig_enable();
+    eeconfig_update_byte(EECONFIG_DEBUG, 0);
+    eeconfig_update_byte(EECONFIG_DEFAULT_LAYER, 0);
     default_layer_state = 0;
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
-    eeprom_update_byte(EECONFIG_BACKLIGHT, 0);
-    eeprom_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
-    eeprom_update_dword(EECONFIG_RGBLIGHT, 0);
-    eeprom_update_byte(EECONFIG_STENOMODE, 0);
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
-    eeprom_update_byte(EECONFIG_VELOCIKEY, 0);
-    eeprom_update_dword(EECONFIG_RGB_MATRIX, 0);
-    eeprom_update_word(EECONFIG_RGB_MATRIX_EXTENDED, 0);
+    eeconfig_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
+    eeconfig_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
+    eeconfig_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
+    eeconfig_update_byte(EECONFIG_BACKLIGHT, 0);
+    eeconfig_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
+    eeconfig_update_dword(EECONFIG_RGBLIGHT, 0);
+    eeconfig_update_byte(EECONFIG_STENOMODE, 0);
+    eeconfig_update_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_update_byte(EECONFIG_VELOCIKEY, 0);
+    eeconfig_update_dword(EECONFIG_RGB_MATRIX, 0);
+    eeconfig_update_word(EECONFIG_RGB_MATRIX_EXTENDED, 0);
 
     // TODO: Remove once ARM has a way to configure EECONFIG_HANDEDNESS
     //        within the emulated eeprom via dfu-util or another tool
 #if defined INIT_EE_HANDS_LEFT
 #    pragma message "Faking EE_HANDS for left hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 1);
+    eeconfig_update_byte(EECONFIG_HANDEDNESS, 1);
 #elif defined INIT_EE_HANDS_RIGHT
 #    pragma message "Faking EE_HANDS for right hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 0);
+    eeconfig_update_byte(EECONFIG_HANDEDNESS, 0);
 #endif
 
 #if defined(HAPTIC_ENABLE)
@@ -81,7 +224,7 @@ void eeconfig_init_quantum(void) {
     // this is used in case haptic is disabled, but we still want sane defaults
     // in the haptic configuration eeprom. All zero will trigger a haptic_reset
     // when a haptic-enabled firmware is loaded onto the keyboard.
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_update_dword(EECONFIG_HAPTIC, 0);
 #endif
 #if defined(VIA_ENABLE)
     // Invalidate VIA eeprom config, and then reset.
@@ -92,6 +235,7 @@ void eeconfig_init_quantum(void) {
 #endif
 
     eeconfig_init_kb();
+    eeconfig_commit();
 }
 
 /** \brief eeconfig initialization
@@ -104,7 +248,16 @@ void eeconfig_init(void) { eeconfig_init_quantum(); }
  *
  * FIXME: needs doc
  */
-void eeconfig_enable(void) { eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER); }
+void eeconfig_enable(void) {
+#ifdef EECONFIG_CACHE
+    // the magic word is sealed with the checksum on commit
+    eeconfig_ensure_loaded();
+    eeconfig_valid = true;
+    eeconfig_mark_dirty(0, sizeof(eeconfig_cache.magic));
+#else
+    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+#endif
+}
 
 /** \brief eeconfig disable
  *
@@ -117,7 +270,15 @@ void eeconfig_disable(void) {
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
 #endif
+#ifdef EECONFIG_CACHE
+    eeconfig_reload();
+    eeconfig_valid       = false;
+    eeconfig_cache.magic = EECONFIG_MAGIC_NUMBER_OFF;
+    eeconfig_mark_dirty(0, sizeof(eeconfig_cache.magic));
+    eeconfig_commit();
+#else
     eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
+#endif
 }
 
 /** \brief eeconfig is enabled
@@ -125,7 +286,12 @@ void eeconfig_disable(void) {
  * FIXME: needs doc
  */
 bool eeconfig_is_enabled(void) {
+#ifdef EECONFIG_CACHE
+    eeconfig_ensure_loaded();
+    bool is_eeprom_enabled = eeconfig_valid;
+#else
     bool is_eeprom_enabled = (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
+#endif
 #ifdef VIA_ENABLE
     if (is_eeprom_enabled) {
         is_eeprom_enabled = via_eeprom_is_valid();
@@ -139,7 +305,12 @@ bool eeconfig_is_enabled(void) {
  * FIXME: needs doc
  */
 bool eeconfig_is_disabled(void) {
+#ifdef EECONFIG_CACHE
+    eeconfig_ensure_loaded();
+    bool is_eeprom_disabled = !eeconfig_valid && eeconfig_cache.magic == EECONFIG_MAGIC_NUMBER_OFF;
+#else
     bool is_eeprom_disabled = (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER_OFF);
+#endif
 #ifdef VIA_ENABLE
     if (!is_eeprom_disabled) {
         is_eeprom_disabled = !via_eeprom_is_valid();
@@ -152,89 +323,89 @@ bool eeconfig_is_disabled(void) {
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_debug(void) { return eeprom_read_byte(EECONFIG_DEBUG); }
+uint8_t eeconfig_read_debug(void) { return eeconfig_read_byte(EECONFIG_DEBUG); }
 /** \brief eeconfig update debug
  *
  * FIXME: needs doc
  */
-void eeconfig_update_debug(uint8_t val) { eeprom_update_byte(EECONFIG_DEBUG, val); }
+void eeconfig_update_debug(uint8_t val) { eeconfig_update_byte(EECONFIG_DEBUG, val); }
 
 /** \brief eeconfig read default layer
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_default_layer(void) { return eeprom_read_byte(EECONFIG_DEFAULT_LAYER); }
+uint8_t eeconfig_read_default_layer(void) { return eeconfig_read_byte(EECONFIG_DEFAULT_LAYER); }
 /** \brief eeconfig update default layer
  *
  * FIXME: needs doc
  */
-void eeconfig_update_default_layer(uint8_t val) { eeprom_update_byte(EECONFIG_DEFAULT_LAYER, val); }
+void eeconfig_update_default_layer(uint8_t val) { eeconfig_update_byte(EECONFIG_DEFAULT_LAYER, val); }
 
 /** \brief eeconfig read keymap
  *
  * FIXME: needs doc
  */
-uint16_t eeconfig_read_keymap(void) { return (eeprom_read_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeprom_read_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
+uint16_t eeconfig_read_keymap(void) { return (eeconfig_read_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeconfig_read_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
 /** \brief eeconfig update keymap
  *
  * FIXME: needs doc
  */
 void eeconfig_update_keymap(uint16_t val) {
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
+    eeconfig_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
+    eeconfig_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
 }
 
 /** \brief eeconfig read audio
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_audio(void) { return eeprom_read_byte(EECONFIG_AUDIO); }
+uint8_t eeconfig_read_audio(void) { return eeconfig_read_byte(EECONFIG_AUDIO); }
 /** \brief eeconfig update audio
  *
  * FIXME: needs doc
  */
-void eeconfig_update_audio(uint8_t val) { eeprom_update_byte(EECONFIG_AUDIO, val); }
+void eeconfig_update_audio(uint8_t val) { eeconfig_update_byte(EECONFIG_AUDIO, val); }
 
 /** \brief eeconfig read kb
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_kb(void) { return eeprom_read_dword(EECONFIG_KEYBOARD); }
+uint32_t eeconfig_read_kb(void) { return eeconfig_read_dword(EECONFIG_KEYBOARD); }
 /** \brief eeconfig update kb
  *
  * FIXME: needs doc
  */
-void eeconfig_update_kb(uint32_t val) { eeprom_update_dword(EECONFIG_KEYBOARD, val); }
+void eeconfig_update_kb(uint32_t val) { eeconfig_update_dword(EECONFIG_KEYBOARD, val); }
 
 /** \brief eeconfig read user
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_user(void) { return eeprom_read_dword(EECONFIG_USER); }
+uint32_t eeconfig_read_user(void) { return eeconfig_read_dword(EECONFIG_USER); }
 /** \brief eeconfig update user
  *
  * FIXME: needs doc
  */
-void eeconfig_update_user(uint32_t val) { eeprom_update_dword(EECONFIG_USER, val); }
+void eeconfig_update_user(uint32_t val) { eeconfig_update_dword(EECONFIG_USER, val); }
 
 /** \brief eeconfig read haptic
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_haptic(void) { return eeprom_read_dword(EECONFIG_HAPTIC); }
+uint32_t eeconfig_read_haptic(void) { return eeconfig_read_dword(EECONFIG_HAPTIC); }
 /** \brief eeconfig update haptic
  *
  * FIXME: needs doc
  */
-void eeconfig_update_haptic(uint32_t val) { eeprom_update_dword(EECONFIG_HAPTIC, val); }
+void eeconfig_update_haptic(uint32_t val) { eeconfig_update_dword(EECONFIG_HAPTIC, val); }
 
 /** \brief eeconfig read split handedness
  *
  * FIXME: needs doc
  */
-bool eeconfig_read_handedness(void) { return !!eeprom_read_byte(EECONFIG_HANDEDNESS); }
+bool eeconfig_read_handedness(void) { return !!eeconfig_read_byte(EECONFIG_HANDEDNESS); }
 /** \brief eeconfig update split handedness
  *
  * FIXME: needs doc
  */
-void eeconfig_update_handedness(bool val) { eeprom_update_byte(EECONFIG_HANDEDNESS, !!val); }
+void eeconfig_update_handedness(bool val) { eeconfig_update_byte(EECONFIG_HANDEDNESS, !!val); }
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef EECONFIG_MAGIC_NUMBER
 #    define EECONFIG_MAGIC_NUMBER (uint16_t)0xFEE9  // When changing, decrement this value to avoid future re-init issues
@@ -55,6 +56,28 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EECONFIG_KEYMAP_UPPER_BYTE (uint8_t *)34
 // Size of EEPROM being used, other code can refer to this for available EEPROM
 #define EECONFIG_SIZE 35
+
+/* The whole eeconfig area as one record, field for field with the addresses above */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t  debug;
+    uint8_t  default_layer;
+    uint8_t  keymap_lower;
+    uint8_t  mousekey_accel;
+    uint8_t  backlight;
+    uint8_t  audio;
+    uint32_t rgblight;
+    uint8_t  unicodemode;
+    uint8_t  stenomode;
+    uint8_t  handedness;
+    uint32_t keyboard;
+    uint32_t user;
+    uint8_t  velocikey;
+    uint32_t haptic;
+    uint32_t rgb_matrix;
+    uint16_t rgb_matrix_extended;
+    uint8_t  keymap_upper;
+} eeconfig_t;
 /* debug bit */
 #define EECONFIG_DEBUG_ENABLE (1 << 0)
 #define EECONFIG_DEBUG_MATRIX (1 << 1)
@@ -85,6 +108,35 @@ void eeconfig_enable(void);
 
 void eeconfig_disable(void);
 
+bool eeconfig_migrate_kb(uint16_t magic);
+bool eeconfig_migrate_user(uint16_t magic);
+
+/* Raw access to the eeconfig area, served from RAM when EECONFIG_CACHE is defined */
+#ifdef EECONFIG_CACHE
+uint8_t  eeconfig_read_byte(const uint8_t *addr);
+uint16_t eeconfig_read_word(const uint16_t *addr);
+uint32_t eeconfig_read_dword(const uint32_t *addr);
+void     eeconfig_read_block(void *buf, const void *addr, size_t len);
+void     eeconfig_update_byte(uint8_t *addr, uint8_t value);
+void     eeconfig_update_word(uint16_t *addr, uint16_t value);
+void     eeconfig_update_dword(uint32_t *addr, uint32_t value);
+void     eeconfig_update_block(const void *buf, void *addr, size_t len);
+void     eeconfig_commit(void);
+void     eeconfig_reload(void);
+#else
+#    include "eeprom.h"
+#    define eeconfig_read_byte eeprom_read_byte
+#    define eeconfig_read_word eeprom_read_word
+#    define eeconfig_read_dword eeprom_read_dword
+#    define eeconfig_read_block eeprom_read_block
+#    define eeconfig_update_byte eeprom_update_byte
+#    define eeconfig_update_word eeprom_update_word
+#    define eeconfig_update_dword eeprom_update_dword
+#    define eeconfig_update_block eeprom_update_block
+#    define eeconfig_commit()
+#    define eeconfig_reload()
+#endif
+
 uint8_t eeconfig_read_debug(void);
 void    eeconfig_update_debug(uint8_t val);
 
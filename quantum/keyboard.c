@@ -31,6 +31,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "scan_profiler.h"
+#include "latency_probe.h"
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -309,6 +311,9 @@ void housekeeping_task(void) {
 void keyboard_init(void) {
     timer_init();
     sync_timer_init();
+#ifdef SCAN_PROFILER_ENABLE
+    scan_profiler_init();
+#endif
 #ifdef VIA_ENABLE
     via_init();
 #endif
@@ -401,10 +406,14 @@ void keyboard_task(void) {
 #ifdef ENCODER_ENABLE
     bool encoders_changed = false;
 #endif
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_TOTAL);
 
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_MATRIX);
     uint8_t matrix_changed = matrix_scan();
     if (matrix_changed) last_matrix_activity_trigger();
+    SCAN_PROFILE_END(SCAN_PHASE_MATRIX);
 
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_ACTION);
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
         matrix_row    = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
@@ -419,6 +428,7 @@ void keyboard_task(void) {
             for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
                 if (matrix_change & col_mask) {
                     if (should_process_keypress()) {
+                        latency_probe_event();
                         action_exec((keyevent_t){
                             .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
                         });
@@ -446,11 +456,13 @@ void keyboard_task(void) {
         action_exec(TICK);
 
 MATRIX_LOOP_END:
+    SCAN_PROFILE_END(SCAN_PHASE_ACTION);
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
 
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_LIGHTING);
 #if defined(RGBLIGHT_ENABLE)
     rgblight_task();
 #endif
@@ -467,16 +479,20 @@ MATRIX_LOOP_END:
     backlight_task();
 #    endif
 #endif
+    SCAN_PROFILE_END(SCAN_PHASE_LIGHTING);
 
 #ifdef ENCODER_ENABLE
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_ENCODER);
     encoders_changed = encoder_read();
     if (encoders_changed) last_encoder_activity_trigger();
+    SCAN_PROFILE_END(SCAN_PHASE_ENCODER);
 #endif
 
 #ifdef QWIIC_ENABLE
     qwiic_task();
 #endif
 
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_DISPLAY);
 #ifdef OLED_ENABLE
     oled_task();
 #    if OLED_TIMEOUT > 0
@@ -500,7 +516,9 @@ MATRIX_LOOP_END:
 #        endif
 #    endif
 #endif
+    SCAN_PROFILE_END(SCAN_PHASE_DISPLAY);
 
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_MOUSE);
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
     mousekey_task();
@@ -517,6 +535,7 @@ MATRIX_LOOP_END:
 #ifdef ADB_MOUSE_ENABLE
     adb_mouse_task();
 #endif
+    SCAN_PROFILE_END(SCAN_PHASE_MOUSE);
 
 #ifdef SERIAL_LINK_ENABLE
     serial_link_update();
@@ -527,7 +546,9 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef POINTING_DEVICE_ENABLE
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_POINTING);
     pointing_device_task();
+    SCAN_PROFILE_END(SCAN_PHASE_POINTING);
 #endif
 
 #ifdef MIDI_ENABLE
@@ -548,11 +569,35 @@ MATRIX_LOOP_END:
     digitizer_task();
 #endif
 
+#ifdef EECONFIG_CACHE
+    eeconfig_commit();
+#endif
+
+#ifdef EEPROM_DRIVER
+    eeprom_driver_task();
+#endif
+
+#ifdef STM32_EEPROM_ENABLE
+    // only start holding up the main loop with flash erases while nothing is being typed,
+    // once pages are being erased the compaction has to finish before flash is consistent again
+    if (EEPROM_Compacting() || last_input_activity_elapsed() > FEE_COMPACTION_IDLE_TIME) {
+        EEPROM_Task();
+    }
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
         keyboard_set_leds(led_status);
     }
+
+    SCAN_PROFILE_END(SCAN_PHASE_TOTAL);
+#ifdef SCAN_PROFILER_ENABLE
+    scan_profiler_task();
+#endif
+#ifdef LATENCY_PROBE_ENABLE
+    latency_probe_task();
+#endif
 }
 
 /** \brief keyboard set leds
@@ -0,0 +1,91 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keystroke_trace.h"
+#include "timer.h"
+#include "print.h"
+#include <string.h>
+
+#define TRACE_MASK (KEYSTROKE_TRACE_SIZE - 1)
+
+_Static_assert((KEYSTROKE_TRACE_SIZE & TRACE_MASK) == 0, "KEYSTROKE_TRACE_SIZE must be a power of two");
+
+static uint8_t  trace[KEYSTROKE_TRACE_SIZE][KEYSTROKE_TRACE_RECORD_SIZE];
+static uint16_t trace_head;  // oldest event
+static uint16_t trace_count;
+static uint32_t last_event_time;
+static bool     recording = false;
+
+void keystroke_trace_start(void) {
+    last_event_time = timer_read32();
+    recording       = true;
+}
+
+void keystroke_trace_stop(void) { recording = false; }
+
+bool keystroke_trace_is_recording(void) { return recording; }
+
+void keystroke_trace_clear(void) {
+    trace_head  = 0;
+    trace_count = 0;
+}
+
+void keystroke_trace_record(keyevent_t event) {
+    if (!recording || IS_NOEVENT(event)) return;
+
+    uint32_t now     = timer_read32();
+    uint32_t elapsed = TIMER_DIFF_32(now, last_event_time);
+    last_event_time  = now;
+
+    keystroke_trace_event_t trace_event = {
+        .delta   = elapsed > UINT16_MAX ? UINT16_MAX : elapsed,
+        .row     = event.key.row,
+        .col     = event.key.col,
+        .pressed = event.pressed,
+    };
+    keystroke_trace_pack(&trace_event, trace[(trace_head + trace_count) & TRACE_MASK]);
+
+    if (trace_count < KEYSTROKE_TRACE_SIZE) {
+        trace_count++;
+    } else {
+        // full, drop the oldest event
+        trace_head = (trace_head + 1) & TRACE_MASK;
+    }
+}
+
+uint16_t keystroke_trace_count(void) { return trace_count; }
+
+uint8_t keystroke_trace_read(uint8_t *data, uint8_t length) {
+    uint8_t written = 0;
+    while (trace_count && length - written >= KEYSTROKE_TRACE_RECORD_SIZE) {
+        memcpy(data + written, trace[trace_head], KEYSTROKE_TRACE_RECORD_SIZE);
+        written += KEYSTROKE_TRACE_RECORD_SIZE;
+        trace_head = (trace_head + 1) & TRACE_MASK;
+        trace_count--;
+    }
+    return written;
+}
+
+void keystroke_trace_print(void) {
+    uint8_t record[KEYSTROKE_TRACE_RECORD_SIZE];
+    while (trace_count) {
+        print("trace:");
+        for (uint8_t i = 0; i < 8 && keystroke_trace_read(record, sizeof(record)); i++) {
+            xprintf(" %02X%02X%02X%02X", record[0], record[1], record[2], record[3]);
+        }
+        print("\n");
+    }
+}
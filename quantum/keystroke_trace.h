@@ -0,0 +1,77 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+// Number of events kept, older ones are overwritten. Must be a power of two.
+#ifndef KEYSTROKE_TRACE_SIZE
+#    define KEYSTROKE_TRACE_SIZE 128
+#endif
+
+/* Every event is packed into KEYSTROKE_TRACE_RECORD_SIZE bytes:
+ *   0-1  milliseconds since the previous event (or since recording started), little endian,
+ *        saturating at 0xFFFF
+ *   2    matrix row
+ *   3    matrix column in bits 0-6, KEYSTROKE_TRACE_PRESSED for a press
+ * A trace is just these records back to back.
+ */
+#define KEYSTROKE_TRACE_RECORD_SIZE 4
+#define KEYSTROKE_TRACE_PRESSED 0x80
+
+typedef struct {
+    uint16_t delta;
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+} keystroke_trace_event_t;
+
+static inline void keystroke_trace_pack(const keystroke_trace_event_t *event, uint8_t *record) {
+    record[0] = event->delta & 0xFF;
+    record[1] = event->delta >> 8;
+    record[2] = event->row;
+    record[3] = (event->col & ~KEYSTROKE_TRACE_PRESSED) | (event->pressed ? KEYSTROKE_TRACE_PRESSED : 0);
+}
+
+static inline void keystroke_trace_unpack(const uint8_t *record, keystroke_trace_event_t *event) {
+    event->delta   = record[0] | (record[1] << 8);
+    event->row     = record[2];
+    event->col     = record[3] & ~KEYSTROKE_TRACE_PRESSED;
+    event->pressed = record[3] & KEYSTROKE_TRACE_PRESSED;
+}
+
+/* Recording has to be started explicitly, the trace holds everything that was typed. */
+void keystroke_trace_start(void);
+void keystroke_trace_stop(void);
+bool keystroke_trace_is_recording(void);
+void keystroke_trace_clear(void);
+
+/* Called from action_exec() for every matrix event. */
+void keystroke_trace_record(keyevent_t event);
+
+/* Number of events waiting to be read. */
+uint16_t keystroke_trace_count(void);
+
+/* Move the oldest events into `data` as packed records, as many as fit in `length` bytes,
+ * e.g. a raw HID report. Returns the number of bytes written.
+ */
+uint8_t keystroke_trace_read(uint8_t *data, uint8_t length);
+
+/* Print and remove all events on the console, as hex records on lines starting with "trace:". */
+void keystroke_trace_print(void);
@@ -0,0 +1,125 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latency_probe.h"
+#include "timer.h"
+#include "print.h"
+#include <string.h>
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <ch.h>
+// system tick, 10us with the default CH_CFG_ST_FREQUENCY
+typedef systime_t latency_probe_ticks_t;
+#    define latency_probe_now() chVTGetSystemTimeX()
+#    define LATENCY_PROBE_TICKS_TO_US(ticks) ((uint32_t)TIME_I2US(ticks))
+#else
+typedef uint32_t latency_probe_ticks_t;
+#    define latency_probe_now() timer_read32()
+#    define LATENCY_PROBE_TICKS_TO_US(ticks) ((ticks)*1000UL)
+#endif
+
+typedef enum {
+    PROBE_IDLE,
+    PROBE_EVENT,
+    PROBE_REPORT,
+    PROBE_TRANSMIT,
+    PROBE_DONE,
+} probe_state_t;
+
+static volatile uint8_t               state = PROBE_IDLE;
+static uint8_t                        endpoint;
+static latency_probe_ticks_t          start;
+static volatile latency_probe_ticks_t end;
+
+static struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t buckets[LATENCY_PROBE_BUCKETS];
+} histogram;
+
+void latency_probe_event(void) {
+    if (state != PROBE_IDLE) return;
+    start = latency_probe_now();
+    state = PROBE_EVENT;
+}
+
+void latency_probe_report(void) {
+    if (state == PROBE_EVENT) state = PROBE_REPORT;
+}
+
+void latency_probe_transmit(uint8_t ep) {
+    if (state != PROBE_REPORT) return;
+    endpoint = ep;
+    state    = PROBE_TRANSMIT;
+}
+
+void latency_probe_complete(uint8_t ep) {
+    if (state != PROBE_TRANSMIT || ep != endpoint) return;
+    end   = latency_probe_now();
+    state = PROBE_DONE;
+}
+
+static void record(uint32_t us) {
+    uint32_t bucket = us / LATENCY_PROBE_BUCKET_US;
+    if (bucket >= LATENCY_PROBE_BUCKETS) bucket = LATENCY_PROBE_BUCKETS - 1;
+    if (histogram.buckets[bucket] < UINT16_MAX) histogram.buckets[bucket]++;
+
+    if (!histogram.count || us < histogram.min) histogram.min = us;
+    if (us > histogram.max) histogram.max = us;
+    histogram.sum += us;
+    histogram.count++;
+}
+
+void latency_probe_task(void) {
+    switch (state) {
+        case PROBE_IDLE:
+            break;
+        case PROBE_DONE:
+            record(LATENCY_PROBE_TICKS_TO_US((latency_probe_ticks_t)(end - start)));
+            state = PROBE_IDLE;
+            break;
+        default:
+            // the report was dropped, or this event never caused one
+            if (LATENCY_PROBE_TICKS_TO_US((latency_probe_ticks_t)(latency_probe_now() - start)) > LATENCY_PROBE_TIMEOUT * 1000UL) {
+                state = PROBE_IDLE;
+            }
+            break;
+    }
+}
+
+void latency_probe_get(latency_probe_stats_t *stats) {
+    stats->count = histogram.count;
+    stats->min   = histogram.min;
+    stats->avg   = histogram.count ? histogram.sum / histogram.count : 0;
+    stats->max   = histogram.max;
+    memcpy(stats->buckets, histogram.buckets, sizeof(stats->buckets));
+}
+
+void latency_probe_reset(void) { memset(&histogram, 0, sizeof(histogram)); }
+
+void latency_probe_print(void) {
+    uprintf("latency: n=%lu min=%lu avg=%lu max=%lu us\n", histogram.count, histogram.min, histogram.count ? (uint32_t)(histogram.sum / histogram.count) : 0, histogram.max);
+    for (uint8_t i = 0; i < LATENCY_PROBE_BUCKETS; i++) {
+        if (!histogram.buckets[i]) continue;
+        if (i == LATENCY_PROBE_BUCKETS - 1) {
+            uprintf("latency >=%5lu us: %u\n", (uint32_t)i * LATENCY_PROBE_BUCKET_US, histogram.buckets[i]);
+        } else {
+            uprintf("latency  %5lu us: %u\n", (uint32_t)i * LATENCY_PROBE_BUCKET_US, histogram.buckets[i]);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Width of a histogram bucket in microseconds
+#ifndef LATENCY_PROBE_BUCKET_US
+#    define LATENCY_PROBE_BUCKET_US 250
+#endif
+
+// Number of buckets, the last one also counts everything slower
+#ifndef LATENCY_PROBE_BUCKETS
+#    define LATENCY_PROBE_BUCKETS 32
+#endif
+
+// Milliseconds after which a sample that never made it to the host is dropped
+#ifndef LATENCY_PROBE_TIMEOUT
+#    define LATENCY_PROBE_TIMEOUT 1000
+#endif
+
+/* All in microseconds. */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint16_t buckets[LATENCY_PROBE_BUCKETS];
+} latency_probe_stats_t;
+
+#ifdef LATENCY_PROBE_ENABLE
+
+/* Only one event is followed at a time, events seen while it is on its way are not sampled.
+ *
+ * latency_probe_event()    keyboard_task() is about to process a matrix change
+ * latency_probe_report()   the next keyboard report is handed to the host driver
+ * latency_probe_transmit() the driver has queued that report on endpoint ep
+ * latency_probe_complete() the transfer on endpoint ep has completed, may be called from an ISR
+ */
+void latency_probe_event(void);
+void latency_probe_report(void);
+void latency_probe_transmit(uint8_t ep);
+void latency_probe_complete(uint8_t ep);
+
+void latency_probe_task(void);
+void latency_probe_get(latency_probe_stats_t *stats);
+void latency_probe_reset(void);
+void latency_probe_print(void);
+
+#else
+
+#    define latency_probe_event()
+#    define latency_probe_report()
+#    define latency_probe_transmit(ep)
+#    define latency_probe_complete(ep)
+
+#endif
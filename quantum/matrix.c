@@ -57,6 +57,25 @@ static SPLIT_MUTABLE_COL pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
 #    endif  // MATRIX_COL_PINS
 #endif
 
+// Read the pins a GPIO port at a time where the platform allows it
+#if defined(getPinPort) && !defined(MATRIX_NO_PORT_READ)
+#    define MATRIX_PORT_READ
+#endif
+
+#if defined(MATRIX_PORT_READ) && !defined(DIRECT_PINS) && (DIODE_DIRECTION == ROW2COL)
+#    if ROWS_PER_HAND <= 8
+typedef uint8_t matrix_pin_state_t;
+#    elif ROWS_PER_HAND <= 16
+typedef uint16_t matrix_pin_state_t;
+#    elif ROWS_PER_HAND <= 32
+typedef uint32_t matrix_pin_state_t;
+#    else
+#        undef MATRIX_PORT_READ
+#    endif
+#else
+typedef matrix_row_t matrix_pin_state_t;
+#endif
+
 /* matrix state(1:on, 0:off) */
 extern matrix_row_t raw_matrix[MATRIX_ROWS];  // raw values
 extern matrix_row_t matrix[MATRIX_ROWS];      // debounced values
@@ -94,10 +113,88 @@ static inline uint8_t readMatrixPin(pin_t pin) {
     }
 }
 
+#ifdef MATRIX_PORT_READ
+/* A run of pins on consecutive bits of one port which are also consecutive columns (or rows),
+ * so the whole run is moved into place with one mask and one shift. Runs on the same port are
+ * kept next to each other, and only the first of them reads the port.
+ */
+typedef struct {
+    pin_t       port;   // any pin of the port
+    port_data_t mask;   // pins of the run
+    uint8_t     bit;    // first pin of the run
+    uint8_t     index;  // first column or row of the run
+    bool        read;   // read the port before this run
+} matrix_pin_run_t;
+
+/* Returns the number of runs, or 0 if the pins must be read one by one. */
+static uint8_t matrix_build_pin_runs(const pin_t *pins, uint8_t count, matrix_pin_run_t *runs) {
+    uint32_t done     = 0;
+    uint8_t  num_runs = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (pins[i] != NO_PIN && getPinBit(pins[i]) >= sizeof(port_data_t) * 8) {
+            return 0;  // port wider than readPort() returns
+        }
+    }
+
+    for (uint8_t first = 0; first < count; first++) {
+        if (pins[first] == NO_PIN || (done & (1UL << first))) continue;
+
+        // Collect all pins on the port of this one
+        bool read = true;
+        for (uint8_t i = first; i < count; i++) {
+            if (pins[i] == NO_PIN || (done & (1UL << i)) || getPinPort(pins[i]) != getPinPort(pins[first])) continue;
+
+            matrix_pin_run_t *run = &runs[num_runs++];
+            run->port             = pins[i];
+            run->mask             = 0;
+            run->bit              = getPinBit(pins[i]);
+            run->index            = i;
+            run->read             = read;
+            read                  = false;
+
+            for (uint8_t j = i; j < count && pins[j] != NO_PIN && !(done & (1UL << j)); j++) {
+                if (getPinPort(pins[j]) != getPinPort(pins[i]) || getPinBit(pins[j]) != run->bit + (j - i)) break;
+                run->mask |= (port_data_t)1 << getPinBit(pins[j]);
+                done |= 1UL << j;
+            }
+        }
+    }
+
+    return num_runs;
+}
+
+/* Returns the pins reading low, bit n for pins[n]. */
+static matrix_pin_state_t matrix_read_pin_runs(const matrix_pin_run_t *runs, uint8_t num_runs) {
+    matrix_pin_state_t state      = 0;
+    port_data_t        port_state = 0;
+
+    for (uint8_t i = 0; i < num_runs; i++) {
+        if (runs[i].read) {
+            port_state = ~readPort(runs[i].port);
+        }
+        state |= (matrix_pin_state_t)((port_state & runs[i].mask) >> runs[i].bit) << runs[i].index;
+    }
+
+    return state;
+}
+#endif
+
 // matrix code
 
 #ifdef DIRECT_PINS
 
+#    ifdef MATRIX_PORT_READ
+static matrix_pin_run_t direct_pin_runs[MATRIX_ROWS][MATRIX_COLS];
+static uint8_t          num_direct_pin_runs[MATRIX_ROWS];
+
+static void matrix_init_pin_runs(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        num_direct_pin_runs[row] = matrix_build_pin_runs(direct_pins[row], MATRIX_COLS, direct_pin_runs[row]);
+    }
+}
+#    endif
+
 __attribute__((weak)) void matrix_init_pins(void) {
     for (int row = 0; row < MATRIX_ROWS; row++) {
         for (int col = 0; col < MATRIX_COLS; col++) {
@@ -113,10 +210,17 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
     // Start with a clear matrix row
     matrix_row_t current_row_value = 0;
 
-    for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
-        pin_t pin = direct_pins[current_row][col_index];
-        if (pin != NO_PIN) {
-            current_row_value |= readPin(pin) ? 0 : (MATRIX_ROW_SHIFTER << col_index);
+#    ifdef MATRIX_PORT_READ
+    if (num_direct_pin_runs[current_row]) {
+        current_row_value = matrix_read_pin_runs(direct_pin_runs[current_row], num_direct_pin_runs[current_row]);
+    } else
+#    endif
+    {
+        for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
+            pin_t pin = direct_pins[current_row][col_index];
+            if (pin != NO_PIN) {
+                current_row_value |= readPin(pin) ? 0 : (MATRIX_ROW_SHIFTER << col_index);
+            }
         }
     }
 
@@ -128,6 +232,13 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
 #    if defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS)
 #        if (DIODE_DIRECTION == COL2ROW)
 
+#            ifdef MATRIX_PORT_READ
+static matrix_pin_run_t col_pin_runs[MATRIX_COLS];
+static uint8_t          num_col_pin_runs;
+
+static void matrix_init_pin_runs(void) { num_col_pin_runs = matrix_build_pin_runs(col_pins, MATRIX_COLS, col_pin_runs); }
+#            endif
+
 static bool select_row(uint8_t row) {
     pin_t pin = row_pins[row];
     if (pin != NO_PIN) {
@@ -168,12 +279,19 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
     }
     matrix_output_select_delay();
 
-    // For each col...
-    for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
-        uint8_t pin_state = readMatrixPin(col_pins[col_index]);
-
-        // Populate the matrix row with the state of the col pin
-        current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
+#            ifdef MATRIX_PORT_READ
+    if (num_col_pin_runs) {
+        current_row_value = matrix_read_pin_runs(col_pin_runs, num_col_pin_runs);
+    } else
+#            endif
+    {
+        // For each col...
+        for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
+            uint8_t pin_state = readMatrixPin(col_pins[col_index]);
+
+            // Populate the matrix row with the state of the col pin
+            current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
+        }
     }
 
     // Unselect row
@@ -186,6 +304,13 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
 
 #        elif (DIODE_DIRECTION == ROW2COL)
 
+#            ifdef MATRIX_PORT_READ
+static matrix_pin_run_t row_pin_runs[ROWS_PER_HAND];
+static uint8_t          num_row_pin_runs;
+
+static void matrix_init_pin_runs(void) { num_row_pin_runs = matrix_build_pin_runs(row_pins, ROWS_PER_HAND, row_pin_runs); }
+#            endif
+
 static bool select_col(uint8_t col) {
     pin_t pin = col_pins[col];
     if (pin != NO_PIN) {
@@ -226,16 +351,32 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
     }
     matrix_output_select_delay();
 
-    // For each row...
-    for (uint8_t row_index = 0; row_index < ROWS_PER_HAND; row_index++) {
-        // Check row pin state
-        if (readMatrixPin(row_pins[row_index]) == 0) {
-            // Pin LO, set col bit
-            current_matrix[row_index] |= (MATRIX_ROW_SHIFTER << current_col);
-            key_pressed = true;
-        } else {
-            // Pin HI, clear col bit
-            current_matrix[row_index] &= ~(MATRIX_ROW_SHIFTER << current_col);
+#            ifdef MATRIX_PORT_READ
+    if (num_row_pin_runs) {
+        matrix_pin_state_t rows_low = matrix_read_pin_runs(row_pin_runs, num_row_pin_runs);
+
+        for (uint8_t row_index = 0; row_index < ROWS_PER_HAND; row_index++, rows_low >>= 1) {
+            if (rows_low & 1) {
+                current_matrix[row_index] |= (MATRIX_ROW_SHIFTER << current_col);
+                key_pressed = true;
+            } else {
+                current_matrix[row_index] &= ~(MATRIX_ROW_SHIFTER << current_col);
+            }
+        }
+    } else
+#            endif
+    {
+        // For each row...
+        for (uint8_t row_index = 0; row_index < ROWS_PER_HAND; row_index++) {
+            // Check row pin state
+            if (readMatrixPin(row_pins[row_index]) == 0) {
+                // Pin LO, set col bit
+                current_matrix[row_index] |= (MATRIX_ROW_SHIFTER << current_col);
+                key_pressed = true;
+            } else {
+                // Pin HI, clear col bit
+                current_matrix[row_index] &= ~(MATRIX_ROW_SHIFTER << current_col);
+            }
         }
     }
 
@@ -252,6 +393,102 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_SCAN_ON_CHANGE
+/* While nothing is pressed all the outputs (rows for COL2ROW) are selected at once, so a key
+ * press anywhere pulls its input low. Only that is checked until then, instead of scanning.
+ */
+#    ifdef DIRECT_PINS
+#        error MATRIX_SCAN_ON_CHANGE needs a matrix with diodes
+#    elif (DIODE_DIRECTION == COL2ROW)
+#        define MATRIX_IDLE_OUTPUT_PINS row_pins
+#        define MATRIX_IDLE_OUTPUTS ROWS_PER_HAND
+#        define MATRIX_IDLE_INPUT_PINS col_pins
+#        define MATRIX_IDLE_INPUTS MATRIX_COLS
+#        define MATRIX_IDLE_INPUT_RUNS col_pin_runs
+#        define MATRIX_IDLE_NUM_INPUT_RUNS num_col_pin_runs
+#    else
+#        define MATRIX_IDLE_OUTPUT_PINS col_pins
+#        define MATRIX_IDLE_OUTPUTS MATRIX_COLS
+#        define MATRIX_IDLE_INPUT_PINS row_pins
+#        define MATRIX_IDLE_INPUTS ROWS_PER_HAND
+#        define MATRIX_IDLE_INPUT_RUNS row_pin_runs
+#        define MATRIX_IDLE_NUM_INPUT_RUNS num_row_pin_runs
+#    endif
+
+static bool matrix_idle = false;
+
+#    ifdef MATRIX_SCAN_ON_CHANGE_INTERRUPT
+#        ifndef PROTOCOL_CHIBIOS
+#            error MATRIX_SCAN_ON_CHANGE_INTERRUPT is only supported on ChibiOS
+#        endif
+static volatile bool matrix_idle_woken;
+
+static void matrix_idle_callback(void *arg) { matrix_idle_woken = true; }
+#    endif
+
+static bool matrix_idle_inputs_low(void) {
+#    ifdef MATRIX_PORT_READ
+    if (MATRIX_IDLE_NUM_INPUT_RUNS) {
+        return matrix_read_pin_runs(MATRIX_IDLE_INPUT_RUNS, MATRIX_IDLE_NUM_INPUT_RUNS) != 0;
+    }
+#    endif
+    for (uint8_t x = 0; x < MATRIX_IDLE_INPUTS; x++) {
+        if (readMatrixPin(MATRIX_IDLE_INPUT_PINS[x]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void matrix_idle_enter(void) {
+    for (uint8_t x = 0; x < MATRIX_IDLE_OUTPUTS; x++) {
+        if (MATRIX_IDLE_OUTPUT_PINS[x] != NO_PIN) {
+            setPinOutput_writeLow(MATRIX_IDLE_OUTPUT_PINS[x]);
+        }
+    }
+#    ifdef MATRIX_SCAN_ON_CHANGE_INTERRUPT
+    matrix_idle_woken = false;
+    for (uint8_t x = 0; x < MATRIX_IDLE_INPUTS; x++) {
+        if (MATRIX_IDLE_INPUT_PINS[x] != NO_PIN) {
+            palEnableLineEvent(MATRIX_IDLE_INPUT_PINS[x], PAL_EVENT_MODE_FALLING_EDGE);
+            palSetLineCallback(MATRIX_IDLE_INPUT_PINS[x], matrix_idle_callback, NULL);
+        }
+    }
+    // a key pressed before the events were enabled has no edge left to report
+    if (matrix_idle_inputs_low()) {
+        matrix_idle_woken = true;
+    }
+#    endif
+    matrix_idle = true;
+}
+
+/* Returns whether a key has been pressed, and if so leaves idle so the matrix can be scanned. */
+static bool matrix_idle_wake(void) {
+#    ifdef MATRIX_SCAN_ON_CHANGE_INTERRUPT
+    if (!matrix_idle_woken) {
+        return false;
+    }
+    for (uint8_t x = 0; x < MATRIX_IDLE_INPUTS; x++) {
+        if (MATRIX_IDLE_INPUT_PINS[x] != NO_PIN) {
+            palDisableLineEvent(MATRIX_IDLE_INPUT_PINS[x]);
+        }
+    }
+#    else
+    if (!matrix_idle_inputs_low()) {
+        return false;
+    }
+#    endif
+    for (uint8_t x = 0; x < MATRIX_IDLE_OUTPUTS; x++) {
+        if (MATRIX_IDLE_OUTPUT_PINS[x] != NO_PIN) {
+            setPinInputHigh_atomic(MATRIX_IDLE_OUTPUT_PINS[x]);
+        }
+    }
+    matrix_output_unselect_delay(0, true);  // wait for all inputs to go HIGH
+    matrix_idle = false;
+    return true;
+}
+#endif
+
 void matrix_init(void) {
 #ifdef SPLIT_KEYBOARD
     split_pre_init();
@@ -285,6 +522,9 @@ void matrix_init(void) {
 #endif
 
     // initialize key pins
+#if defined(MATRIX_PORT_READ) && (defined(DIRECT_PINS) || (defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS)))
+    matrix_init_pin_runs();
+#endif
     matrix_init_pins();
 
     // initialize matrix state: all keys off
@@ -343,27 +583,48 @@ bool matrix_post_scan(void) {
 
 uint8_t matrix_scan(void) {
     matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
+    bool         changed                  = false;
 
+#ifdef MATRIX_SCAN_ON_CHANGE
+    // while idle nothing is pressed, raw_matrix stays all zero until an input goes low
+    if (!matrix_idle || matrix_idle_wake())
+#endif
+    {
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
-    // Set row, read cols
-    for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
-        matrix_read_cols_on_row(curr_matrix, current_row);
-    }
+        // Set row, read cols
+        for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
+            matrix_read_cols_on_row(curr_matrix, current_row);
+        }
 #elif (DIODE_DIRECTION == ROW2COL)
-    // Set col, read rows
-    for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++) {
-        matrix_read_rows_on_col(curr_matrix, current_col);
-    }
+        // Set col, read rows
+        for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++) {
+            matrix_read_rows_on_col(curr_matrix, current_col);
+        }
 #endif
 
-    bool changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
-    if (changed) memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
+        changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
+        if (changed) memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
+
+#ifdef MATRIX_SCAN_ON_CHANGE
+        bool any_pressed = false;
+        for (uint8_t i = 0; i < ROWS_PER_HAND; i++) {
+            any_pressed |= curr_matrix[i] != 0;
+        }
+        if (!any_pressed) {
+            // debounce() still runs on every scan, so pending releases are reported on time
+            matrix_idle_enter();
+        }
+#endif
+    }
 
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_DEBOUNCE);
 #ifdef SPLIT_KEYBOARD
     debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed);
+    SCAN_PROFILE_END(SCAN_PHASE_DEBOUNCE);
     changed = (changed || matrix_post_scan());
 #else
     debounce(raw_matrix, matrix, ROWS_PER_HAND, changed);
+    SCAN_PROFILE_END(SCAN_PHASE_DEBOUNCE);
     matrix_scan_quantum();
 #endif
     return (uint8_t)changed;
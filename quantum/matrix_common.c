@@ -112,7 +112,9 @@ __attribute__((weak)) void matrix_init(void) {
 __attribute__((weak)) uint8_t matrix_scan(void) {
     bool changed = matrix_scan_custom(raw_matrix);
 
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_DEBOUNCE);
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    SCAN_PROFILE_END(SCAN_PHASE_DEBOUNCE);
 
     matrix_scan_quantum();
     return changed;
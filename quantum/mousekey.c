@@ -23,12 +23,16 @@
 #include "debug.h"
 #include "mousekey.h"
 
-inline int8_t times_inv_sqrt2(int8_t x) {
+inline mouse_xy_report_t times_inv_sqrt2(mouse_xy_report_t x) {
     // 181/256 is pretty close to 1/sqrt(2)
     // 0.70703125                 0.707106781
     // 1 too small for x=99 and x=198
     // This ends up being a mult and discard lower 8 bits
+#ifdef MOUSE_EXTENDED_REPORT
+    return ((int32_t)x * 181) >> 8;
+#else
     return (x * 181) >> 8;
+#endif
 }
 
 static report_mouse_t mouse_report = {0};
@@ -71,7 +75,7 @@ uint8_t mk_wheel_time_to_max = MOUSEKEY_WHEEL_TIME_TO_MAX;
 
 #    ifndef MK_COMBINED
 
-static uint8_t move_unit(void) {
+static mouse_xy_report_t move_unit(void) {
     uint16_t unit;
     if (mousekey_accel & (1 << 0)) {
         unit = (MOUSEKEY_MOVE_DELTA * mk_max_speed) / 4;
@@ -127,7 +131,7 @@ const uint16_t mk_base_speed        = MOUSEKEY_BASE_SPEED;
 const uint16_t mk_decelerated_speed = MOUSEKEY_DECELERATED_SPEED;
 const uint16_t mk_initial_speed     = MOUSEKEY_INITIAL_SPEED;
 
-static uint8_t move_unit(void) {
+static mouse_xy_report_t move_unit(void) {
     float speed = mk_initial_speed;
 
     if (mousekey_accel & ((1 << 0) | (1 << 2))) {
@@ -139,8 +143,8 @@ static uint8_t move_unit(void) {
         speed = speed > mk_base_speed ? mk_base_speed : speed;
     }
 
-    /* convert speed to USB mouse speed 1 to 127 */
-    speed = (uint8_t)(speed / (1000.0f / mk_interval));
+    /* convert speed to USB mouse speed 1 to MOUSEKEY_MOVE_MAX */
+    speed = (uint16_t)(speed / (1000.0f / mk_interval));
     speed = speed < 1 ? 1 : speed;
 
     return speed > MOUSEKEY_MOVE_MAX ? MOUSEKEY_MOVE_MAX : speed;
@@ -168,7 +172,7 @@ static uint8_t wheel_unit(void) {
 
 #        else /* #ifndef MK_KINETIC_SPEED */
 
-static uint8_t move_unit(void) {
+static mouse_xy_report_t move_unit(void) {
     uint16_t unit;
     if (mousekey_accel & (1 << 0)) {
         unit = 1;
@@ -458,7 +462,15 @@ void mousekey_send(void) {
     uint16_t time = timer_read();
     if (mouse_report.x || mouse_report.y) last_timer_c = time;
     if (mouse_report.v || mouse_report.h) last_timer_w = time;
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+    // the wheels count in notches here, the host may expect fractions of one
+    report_mouse_t report = mouse_report;
+    report.v *= host_mouse_scroll_multiplier();
+    report.h *= host_mouse_scroll_multiplier();
+    host_mouse_send(&report);
+#else
     host_mouse_send(&mouse_report);
+#endif
 }
 
 void mousekey_clear(void) {
@@ -25,8 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /* max value on report descriptor */
 #    ifndef MOUSEKEY_MOVE_MAX
 #        define MOUSEKEY_MOVE_MAX 127
-#    elif MOUSEKEY_MOVE_MAX > 127
-#        error MOUSEKEY_MOVE_MAX needs to be smaller than 127
+#    elif MOUSEKEY_MOVE_MAX > MOUSE_REPORT_XY_MAX
+#        error MOUSEKEY_MOVE_MAX needs to be smaller than MOUSE_REPORT_XY_MAX
 #    endif
 
 #    ifndef MOUSEKEY_WHEEL_MAX
@@ -23,7 +23,41 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "debug.h"
 #include "pointing_device.h"
 
-static report_mouse_t mouseReport = {};
+#ifndef POINTING_DEVICE_MOTION_SCALE
+#    define POINTING_DEVICE_MOTION_SCALE 256
+#endif
+
+/* Reports carry all the motion since the previous one, sending them faster than the host polls
+ * would only block the main loop until it does. Button changes are sent right away.
+ */
+#ifndef POINTING_DEVICE_REPORT_INTERVAL_MS
+#    ifdef USB_POLLING_INTERVAL_MS
+#        define POINTING_DEVICE_REPORT_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#    else
+#        define POINTING_DEVICE_REPORT_INTERVAL_MS 10
+#    endif
+#endif
+
+/* Motion beyond what fits in a report is carried over to the following ones, but only this many
+ * reports' worth. The rest is dropped, so a flick doesn't keep the cursor moving after the hand stops.
+ */
+#ifndef POINTING_DEVICE_MOTION_CARRY
+#    define POINTING_DEVICE_MOTION_CARRY 1
+#endif
+
+// fixed point 24.8, the fraction of a count is carried over to the next report
+#define MOTION_ONE 256
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t v;
+    int32_t h;
+} pointing_device_motion_t;
+
+static report_mouse_t           mouseReport  = {};
+static pointing_device_motion_t motion       = {};
+static uint16_t                 motion_scale = POINTING_DEVICE_MOTION_SCALE;
 
 __attribute__((weak)) bool has_mouse_report_changed(report_mouse_t new, report_mouse_t old) { return (new.buttons != old.buttons) || (new.x&& new.x != old.x) || (new.y&& new.y != old.y) || (new.h&& new.h != old.h) || (new.v&& new.v != old.v); }
 
@@ -31,12 +65,54 @@ __attribute__((weak)) void pointing_device_init(void) {
     // initialize device, if that needs to be done.
 }
 
+void pointing_device_add_motion(int16_t x, int16_t y) {
+    motion.x += (int32_t)x * motion_scale;
+    motion.y += (int32_t)y * motion_scale;
+}
+
+void pointing_device_set_motion_scale(uint16_t scale) { motion_scale = scale; }
+
+/* Moves as much of the accumulated motion into a report field as fits, and leaves the rest up to the carry limit. */
+static int16_t pointing_device_take_motion(int32_t *accumulated, int16_t max) {
+    int32_t counts = *accumulated / MOTION_ONE;  // rounds towards zero, the fraction keeps its sign
+
+    if (counts > max) {
+        counts = max;
+    } else if (counts < -max) {
+        counts = -max;
+    }
+    *accumulated -= counts * MOTION_ONE;
+
+    int32_t carry = (int32_t)max * POINTING_DEVICE_MOTION_CARRY * MOTION_ONE + (MOTION_ONE - 1);
+    if (*accumulated > carry) {
+        *accumulated = carry;
+    } else if (*accumulated < -carry) {
+        *accumulated = -carry;
+    }
+    return counts;
+}
+
 __attribute__((weak)) void pointing_device_send(void) {
     static report_mouse_t old_report = {};
+    static uint16_t       last_send  = 0;
+
+    // movement put straight into the report joins the accumulated motion, scrolling counts in notches
+    motion.x += (int32_t)mouseReport.x * MOTION_ONE;
+    motion.y += (int32_t)mouseReport.y * MOTION_ONE;
+    motion.v += (int32_t)mouseReport.v * MOTION_ONE * host_mouse_scroll_multiplier();
+    motion.h += (int32_t)mouseReport.h * MOTION_ONE * host_mouse_scroll_multiplier();
+
+    if (mouseReport.buttons != old_report.buttons || timer_elapsed(last_send) >= POINTING_DEVICE_REPORT_INTERVAL_MS) {
+        mouseReport.x = pointing_device_take_motion(&motion.x, MOUSE_REPORT_XY_MAX);
+        mouseReport.y = pointing_device_take_motion(&motion.y, MOUSE_REPORT_XY_MAX);
+        mouseReport.v = pointing_device_take_motion(&motion.v, MOUSE_REPORT_HV_MAX);
+        mouseReport.h = pointing_device_take_motion(&motion.h, MOUSE_REPORT_HV_MAX);
 
-    // If you need to do other things, like debugging, this is the place to do it.
-    if (has_mouse_report_changed(mouseReport, old_report)) {
-        host_mouse_send(&mouseReport);
+        // If you need to do other things, like debugging, this is the place to do it.
+        if (has_mouse_report_changed(mouseReport, old_report)) {
+            host_mouse_send(&mouseReport);
+            last_send = timer_read();
+        }
     }
     // send it and 0 it out except for buttons, so those stay until they are explicity over-ridden using update_pointing_device
     mouseReport.x = 0;
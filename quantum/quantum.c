@@ -41,6 +41,14 @@
 #    include "haptic.h"
 #endif
 
+#ifdef EEPROM_DRIVER
+#    include "eeprom_driver.h"
+#endif
+
+#ifdef STM32_EEPROM_ENABLE
+#    include "eeprom_stm32.h"
+#endif
+
 #ifdef AUDIO_ENABLE
 #    ifndef GOODBYE_SONG
 #        define GOODBYE_SONG SONG(GOODBYE_SOUND)
@@ -138,6 +146,17 @@ void reset_keyboard(void) {
 #endif
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
+#endif
+#ifdef EECONFIG_CACHE
+    eeconfig_commit();
+#endif
+#ifdef EEPROM_DRIVER
+    // don't lose settings still waiting in the write-behind cache
+    eeprom_driver_flush();
+#endif
+#ifdef STM32_EEPROM_ENABLE
+    // finish a background compaction, flash is not consistent until then
+    EEPROM_Flush();
 #endif
     bootloader_jump();
 }
@@ -194,112 +213,148 @@ void post_process_record_quantum(keyrecord_t *record) {
     post_process_record_kb(keycode, record);
 }
 
-/* Core keycode function, hands off handling to other functions,
-    then processes internal quantum keycodes, and then processes
-    ACTIONs.                                                      */
-bool process_record_quantum(keyrecord_t *record) {
-    uint16_t keycode = get_record_keycode(record, true);
-
-    // This is how you use actions here
-    // if (keycode == KC_LEAD) {
-    //   action_t action;
-    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
-    //   process_action(record, action);
-    //   return false;
-    // }
-
-#ifdef VELOCIKEY_ENABLE
-    if (velocikey_enabled() && record->event.pressed) {
-        velocikey_accelerate();
-    }
+// Adapters for the handlers taking a const record
+#ifdef KEY_OVERRIDE_ENABLE
+static bool process_key_override_record(uint16_t keycode, keyrecord_t *record) { return process_key_override(keycode, record); }
 #endif
-
-#ifdef WPM_ENABLE
-    if (record->event.pressed) {
-        update_wpm(keycode);
-    }
+#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+static bool process_rgb_record(uint16_t keycode, keyrecord_t *record) { return process_rgb(keycode, record); }
 #endif
 
-#ifdef TAP_DANCE_ENABLE
-    preprocess_tap_dance(keycode, record);
-#endif
+typedef bool (*process_record_handler_t)(uint16_t keycode, keyrecord_t *record);
 
-    if (!(
-#if defined(KEY_LOCK_ENABLE)
-            // Must run first to be able to mask key_up events.
-            process_key_lock(&keycode, record) &&
-#endif
+typedef struct {
+    process_record_handler_t handler;
+    uint16_t                 first;  // range of keycodes the handler acts on
+    uint16_t                 last;
+} process_record_dispatch_t;
+
+#define PROCESS_EVERY_KEY(handler) \
+    { handler, 0, UINT16_MAX }
+#define PROCESS_KEYCODES(handler, first, last) \
+    { handler, first, last }
+
+/* Called in order for every key until one returns false. Handlers which only act on their own
+ * keycodes are skipped for all others, the rest need to see every key, for example to notice
+ * when another key interrupts them.
+ */
+static const process_record_dispatch_t PROGMEM process_record_handlers[] = {
 #if defined(DYNAMIC_MACRO_ENABLE) && !defined(DYNAMIC_MACRO_USER_CALL)
-            // Must run asap to ensure all keypresses are recorded.
-            process_dynamic_macro(keycode, record) &&
+    // Must run asap to ensure all keypresses are recorded.
+    PROCESS_EVERY_KEY(process_dynamic_macro),
 #endif
 #if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
-            process_clicky(keycode, record) &&
+    PROCESS_EVERY_KEY(process_clicky),
 #endif
 #ifdef HAPTIC_ENABLE
-            process_haptic(keycode, record) &&
+    PROCESS_EVERY_KEY(process_haptic),
 #endif
 #if defined(VIA_ENABLE)
-            process_record_via(keycode, record) &&
+    PROCESS_KEYCODES(process_record_via, FN_MO13, MACRO15),
 #endif
-            process_record_kb(keycode, record) &&
+    PROCESS_EVERY_KEY(process_record_kb),
 #if defined(SEQUENCER_ENABLE)
-            process_sequencer(keycode, record) &&
+    PROCESS_KEYCODES(process_sequencer, SQ_ON, SEQUENCER_TRACK_MAX),
 #endif
 #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-            process_midi(keycode, record) &&
+    PROCESS_KEYCODES(process_midi, MI_ON, MI_BENDU),
 #endif
 #ifdef AUDIO_ENABLE
-            process_audio(keycode, record) &&
+    PROCESS_KEYCODES(process_audio, AU_ON, MUV_DE),
 #endif
 #if defined(BACKLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE)
-            process_backlight(keycode, record) &&
+    PROCESS_KEYCODES(process_backlight, BL_ON, BL_BRTG),
 #endif
 #ifdef STENO_ENABLE
-            process_steno(keycode, record) &&
+    PROCESS_KEYCODES(process_steno, QK_STENO, QK_STENO_MAX),
 #endif
 #if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
-            process_music(keycode, record) &&
+    PROCESS_EVERY_KEY(process_music),
 #endif
 #ifdef KEY_OVERRIDE_ENABLE
-            process_key_override(keycode, record) &&
+    PROCESS_EVERY_KEY(process_key_override_record),
 #endif
 #ifdef TAP_DANCE_ENABLE
-            process_tap_dance(keycode, record) &&
+    PROCESS_EVERY_KEY(process_tap_dance),
 #endif
 #if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
-            process_unicode_common(keycode, record) &&
+    PROCESS_EVERY_KEY(process_unicode_common),
 #endif
 #ifdef LEADER_ENABLE
-            process_leader(keycode, record) &&
+    PROCESS_EVERY_KEY(process_leader),
 #endif
 #ifdef PRINTING_ENABLE
-            process_printer(keycode, record) &&
+    PROCESS_EVERY_KEY(process_printer),
 #endif
 #ifdef AUTO_SHIFT_ENABLE
-            process_auto_shift(keycode, record) &&
+    PROCESS_EVERY_KEY(process_auto_shift),
 #endif
 #ifdef TERMINAL_ENABLE
-            process_terminal(keycode, record) &&
+    PROCESS_EVERY_KEY(process_terminal),
 #endif
 #ifdef SPACE_CADET_ENABLE
-            process_space_cadet(keycode, record) &&
+    PROCESS_EVERY_KEY(process_space_cadet),
 #endif
 #ifdef MAGIC_KEYCODE_ENABLE
-            process_magic(keycode, record) &&
+    PROCESS_KEYCODES(process_magic, MAGIC_SWAP_CONTROL_CAPSLOCK, MAGIC_TOGGLE_GUI),
 #endif
 #ifdef GRAVE_ESC_ENABLE
-            process_grave_esc(keycode, record) &&
+    PROCESS_KEYCODES(process_grave_esc, GRAVE_ESC, GRAVE_ESC),
 #endif
 #if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
-            process_rgb(keycode, record) &&
+    PROCESS_KEYCODES(process_rgb_record, RGB_TOG, RGB_MODE_TWINKLE),
 #endif
 #ifdef JOYSTICK_ENABLE
-            process_joystick(keycode, record) &&
+    PROCESS_KEYCODES(process_joystick, JS_BUTTON_MIN, JS_BUTTON_MAX),
 #endif
-            true)) {
+};
+
+/* Core keycode function, hands off handling to other functions,
+    then processes internal quantum keycodes, and then processes
+    ACTIONs.                                                      */
+bool process_record_quantum(keyrecord_t *record) {
+    uint16_t keycode = get_record_keycode(record, true);
+
+    // This is how you use actions here
+    // if (keycode == KC_LEAD) {
+    //   action_t action;
+    //   action.code = ACTION_DEFAULT_LAYER_SET(0);
+    //   process_action(record, action);
+    //   return false;
+    // }
+
+#ifdef VELOCIKEY_ENABLE
+    if (velocikey_enabled() && record->event.pressed) {
+        velocikey_accelerate();
+    }
+#endif
+
+#ifdef WPM_ENABLE
+    if (record->event.pressed) {
+        update_wpm(keycode);
+    }
+#endif
+
+#ifdef TAP_DANCE_ENABLE
+    preprocess_tap_dance(keycode, record);
+#endif
+
+#if defined(KEY_LOCK_ENABLE)
+    // Must run first to be able to mask key_up events.
+    if (!process_key_lock(&keycode, record)) {
         return false;
     }
+#endif
+
+    for (uint8_t i = 0; i < sizeof(process_record_handlers) / sizeof(process_record_handlers[0]); i++) {
+        if (keycode < pgm_read_word(&process_record_handlers[i].first) || keycode > pgm_read_word(&process_record_handlers[i].last)) {
+            continue;
+        }
+        process_record_handler_t handler = (process_record_handler_t)pgm_read_ptr(&process_record_handlers[i].handler);
+        if (!handler(keycode, record)) {
+            return false;
+        }
+    }
 
     if (record->event.pressed) {
         switch (keycode) {
@@ -432,11 +487,15 @@ void matrix_scan_quantum() {
 #endif
 
 #ifdef TAP_DANCE_ENABLE
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_TAP_DANCE);
     tap_dance_task();
+    SCAN_PROFILE_END(SCAN_PHASE_TAP_DANCE);
 #endif
 
 #ifdef COMBO_ENABLE
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_COMBO);
     combo_task();
+    SCAN_PROFILE_END(SCAN_PHASE_COMBO);
 #endif
 
 #ifdef LED_MATRIX_ENABLE
@@ -51,6 +51,7 @@
 #include "print.h"
 #include "send_string.h"
 #include "suspend.h"
+#include "scan_profiler.h"
 #include <stddef.h>
 #include <stdlib.h>
 
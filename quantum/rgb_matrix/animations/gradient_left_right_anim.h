@@ -1,5 +1,5 @@
 #ifdef ENABLE_RGB_MATRIX_GRADIENT_LEFT_RIGHT
-RGB_MATRIX_EFFECT(GRADIENT_LEFT_RIGHT)
+RGB_MATRIX_EFFECT(GRADIENT_LEFT_RIGHT, RGB_MATRIX_REFRESH_STATIC)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 bool GRADIENT_LEFT_RIGHT(effect_params_t* params) {
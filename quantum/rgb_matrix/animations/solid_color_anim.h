@@ -1,4 +1,4 @@
-RGB_MATRIX_EFFECT(SOLID_COLOR)
+RGB_MATRIX_EFFECT(SOLID_COLOR, RGB_MATRIX_REFRESH_STATIC)
 #ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 bool SOLID_COLOR(effect_params_t* params) {
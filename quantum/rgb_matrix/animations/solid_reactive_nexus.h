@@ -2,11 +2,11 @@
 #    if !defined(DISABLE_RGB_MATRIX_SOLID_REACTIVE_NEXUS) || !defined(DISABLE_RGB_MATRIX_SOLID_REACTIVE_MULTINEXUS)
 
 #        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_NEXUS
-RGB_MATRIX_EFFECT(SOLID_REACTIVE_NEXUS)
+RGB_MATRIX_EFFECT(SOLID_REACTIVE_NEXUS, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_MULTINEXUS
-RGB_MATRIX_EFFECT(SOLID_REACTIVE_MULTINEXUS)
+RGB_MATRIX_EFFECT(SOLID_REACTIVE_MULTINEXUS, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
@@ -2,11 +2,11 @@
 #    if !defined(DISABLE_RGB_MATRIX_SOLID_REACTIVE_WIDE) || !defined(DISABLE_RGB_MATRIX_SOLID_REACTIVE_MULTIWIDE)
 
 #        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_WIDE
-RGB_MATRIX_EFFECT(SOLID_REACTIVE_WIDE)
+RGB_MATRIX_EFFECT(SOLID_REACTIVE_WIDE, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_MULTIWIDE
-RGB_MATRIX_EFFECT(SOLID_REACTIVE_MULTIWIDE)
+RGB_MATRIX_EFFECT(SOLID_REACTIVE_MULTIWIDE, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
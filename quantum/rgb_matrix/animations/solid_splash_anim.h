@@ -2,11 +2,11 @@
 #    if !defined(DISABLE_RGB_MATRIX_SOLID_SPLASH) || !defined(DISABLE_RGB_MATRIX_SOLID_MULTISPLASH)
 
 #        ifndef DISABLE_RGB_MATRIX_SOLID_SPLASH
-RGB_MATRIX_EFFECT(SOLID_SPLASH)
+RGB_MATRIX_EFFECT(SOLID_SPLASH, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifndef DISABLE_RGB_MATRIX_SOLID_MULTISPLASH
-RGB_MATRIX_EFFECT(SOLID_MULTISPLASH)
+RGB_MATRIX_EFFECT(SOLID_MULTISPLASH, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
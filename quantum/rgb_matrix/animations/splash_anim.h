@@ -2,11 +2,11 @@
 #    if !defined(DISABLE_RGB_MATRIX_SPLASH) || !defined(DISABLE_RGB_MATRIX_MULTISPLASH)
 
 #        ifndef DISABLE_RGB_MATRIX_SPLASH
-RGB_MATRIX_EFFECT(SPLASH)
+RGB_MATRIX_EFFECT(SPLASH, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifndef DISABLE_RGB_MATRIX_MULTISPLASH
-RGB_MATRIX_EFFECT(MULTISPLASH)
+RGB_MATRIX_EFFECT(MULTISPLASH, RGB_MATRIX_REFRESH_REACTIVE)
 #        endif
 
 #        ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
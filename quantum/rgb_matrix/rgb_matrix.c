@@ -46,7 +46,7 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 
 // ------------------------------------------
 // -----Begin rgb effect includes macros-----
-#define RGB_MATRIX_EFFECT(name)
+#define RGB_MATRIX_EFFECT(name, ...)
 #define RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 #include "rgb_matrix_effects.inc"
@@ -133,9 +133,18 @@ static uint8_t         rgb_last_enable   = UINT8_MAX;
 static uint8_t         rgb_last_effect   = UINT8_MAX;
 static effect_params_t rgb_effect_params = {0, LED_FLAG_ALL, false};
 static rgb_task_states rgb_task_state    = SYNCING;
+#ifdef RGB_MATRIX_COMPOSITOR
+static uint8_t         rgb_overlay_effect      = RGB_MATRIX_NONE;
+static uint8_t         rgb_last_overlay_effect = RGB_MATRIX_NONE;
+static effect_params_t rgb_overlay_params      = {0, LED_FLAG_ALL, false};
+#endif  // RGB_MATRIX_COMPOSITOR
 #if RGB_DISABLE_TIMEOUT > 0
 static uint32_t rgb_anykey_timer;
 #endif  // RGB_DISABLE_TIMEOUT > 0
+#ifdef RGB_MATRIX_ADAPTIVE_FRAME_RATE
+static uint32_t     rgb_keypress_timer;
+static rgb_config_t rgb_last_config;
+#endif  // RGB_MATRIX_ADAPTIVE_FRAME_RATE
 
 // double buffers
 static uint32_t rgb_timer_buffer;
@@ -148,9 +157,9 @@ static last_hit_t last_hit_buffer;
 const uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
 #endif
 
-void eeconfig_read_rgb_matrix(void) { eeprom_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_read_rgb_matrix(void) { eeconfig_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
-void eeconfig_update_rgb_matrix(void) { eeprom_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_update_rgb_matrix(void) { eeconfig_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
 void eeconfig_update_rgb_matrix_default(void) {
     dprintf("eeconfig_update_rgb_matrix_default\n");
@@ -187,7 +196,9 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
 
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
 
-void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+static inline bool rgb_matrix_driver_ready(void) { return !rgb_matrix_driver.ready || rgb_matrix_driver.ready(); }
+
+static void rgb_matrix_write_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
 #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
     if (!is_keyboard_left() && index >= k_rgb_matrix_split[0])
         rgb_matrix_driver.set_color(index - k_rgb_matrix_split[0], red, green, blue);
@@ -196,8 +207,18 @@ void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
         rgb_matrix_driver.set_color(index, red, green, blue);
 }
 
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_COMPOSITOR
+    rgb_matrix_compositor_set_color(index, red, green, blue);
+#else
+    rgb_matrix_write_color(index, red, green, blue);
+#endif
+}
+
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
-#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#if defined(RGB_MATRIX_COMPOSITOR)
+    rgb_matrix_compositor_set_color_all(red, green, blue);
+#elif defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
     for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) rgb_matrix_set_color(i, red, green, blue);
 #else
     rgb_matrix_driver.set_color_all(red, green, blue);
@@ -211,6 +232,9 @@ void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
 #if RGB_DISABLE_TIMEOUT > 0
     rgb_anykey_timer = 0;
 #endif  // RGB_DISABLE_TIMEOUT > 0
+#ifdef RGB_MATRIX_ADAPTIVE_FRAME_RATE
+    rgb_keypress_timer = sync_timer_read32();
+#endif  // RGB_MATRIX_ADAPTIVE_FRAME_RATE
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     uint8_t led[LED_HITS_TO_REMEMBER];
@@ -313,16 +337,109 @@ static void rgb_task_timers(void) {
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 }
 
-static void rgb_task_sync(void) {
+#ifdef RGB_MATRIX_ADAPTIVE_FRAME_RATE
+static rgb_matrix_refresh_t rgb_matrix_effect_refresh(uint8_t effect) {
+    switch (effect) {
+        case RGB_MATRIX_NONE:
+            return RGB_MATRIX_REFRESH_STATIC;
+
+// ----------------------------------------------
+// -----Begin rgb effect refresh case macros-----
+// effects without a second argument are animated
+#    define RGB_MATRIX_EFFECT_REFRESH(name, refresh, ...) refresh
+#    define RGB_MATRIX_EFFECT(name, ...) \
+        case RGB_MATRIX_##name:          \
+            return RGB_MATRIX_EFFECT_REFRESH(name, ##__VA_ARGS__, RGB_MATRIX_REFRESH_ANIMATED);
+#    include "rgb_matrix_effects.inc"
+#    undef RGB_MATRIX_EFFECT
+
+#    if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
+#        define RGB_MATRIX_EFFECT(name, ...) \
+            case RGB_MATRIX_CUSTOM_##name:   \
+                return RGB_MATRIX_EFFECT_REFRESH(name, ##__VA_ARGS__, RGB_MATRIX_REFRESH_ANIMATED);
+#        ifdef RGB_MATRIX_CUSTOM_KB
+#            include "rgb_matrix_kb.inc"
+#        endif
+#        ifdef RGB_MATRIX_CUSTOM_USER
+#            include "rgb_matrix_user.inc"
+#        endif
+#        undef RGB_MATRIX_EFFECT
+#    endif
+#    undef RGB_MATRIX_EFFECT_REFRESH
+            // -----End rgb effect refresh case macros-------
+            // ----------------------------------------------
+    }
+
+    return RGB_MATRIX_REFRESH_ANIMATED;
+}
+
+static uint32_t rgb_matrix_effect_interval(uint8_t effect, uint32_t since_keypress) {
+    uint8_t speed = rgb_matrix_config.speed;
+
+    switch (rgb_matrix_effect_refresh(effect)) {
+        case RGB_MATRIX_REFRESH_ANIMATED:
+            // most effects advance their hue or position by one step every 1024 / speed ms,
+            // frames in between would look the same
+            if (speed) {
+                uint32_t interval = 1024 / speed;
+                if (interval < RGB_MATRIX_LED_FLUSH_LIMIT) return RGB_MATRIX_LED_FLUSH_LIMIT;
+                if (interval < RGB_MATRIX_IDLE_FLUSH_LIMIT) return interval;
+            }
+            break;
+        case RGB_MATRIX_REFRESH_REACTIVE:
+            // hits fade out within 65535 / (speed + 1) ms, splashes take up to twice as long to spread
+            if (since_keypress < 2UL * UINT16_MAX / qadd8(speed, 1)) return RGB_MATRIX_LED_FLUSH_LIMIT;
+            break;
+        default:
+            break;
+    }
+
+    return RGB_MATRIX_IDLE_FLUSH_LIMIT;
+}
+
+static uint32_t rgb_matrix_frame_interval(uint8_t effect) {
+    uint32_t since_keypress = sync_timer_elapsed32(rgb_keypress_timer);
+
+    // settings changes and indicators should still show up straight away
+    if (effect != rgb_last_effect || rgb_matrix_config.raw != rgb_last_config.raw || rgb_matrix_config.speed != rgb_last_config.speed || rgb_matrix_config.flags != rgb_last_config.flags || since_keypress < RGB_MATRIX_KEYPRESS_BOOST) {
+        return RGB_MATRIX_LED_FLUSH_LIMIT;
+    }
+
+    uint32_t interval = rgb_matrix_effect_interval(effect, since_keypress);
+#    ifdef RGB_MATRIX_COMPOSITOR
+    if (effect != RGB_MATRIX_NONE && rgb_overlay_effect != RGB_MATRIX_NONE) {
+        uint32_t overlay_interval = rgb_matrix_effect_interval(rgb_overlay_effect, since_keypress);
+        if (overlay_interval < interval) interval = overlay_interval;
+    }
+#    endif  // RGB_MATRIX_COMPOSITOR
+    return interval;
+}
+#endif  // RGB_MATRIX_ADAPTIVE_FRAME_RATE
+
+static void rgb_task_sync(uint8_t effect) {
     // next task
     if (rgb_update_eeprom) eeconfig_update_rgb_matrix();
     rgb_update_eeprom = false;
-    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+#ifdef RGB_MATRIX_ADAPTIVE_FRAME_RATE
+    uint32_t interval = rgb_matrix_frame_interval(effect);
+#else
+    uint32_t interval = RGB_MATRIX_LED_FLUSH_LIMIT;
+#endif  // RGB_MATRIX_ADAPTIVE_FRAME_RATE
+    // wait for the driver to take the last frame before rendering the next one
+    if (sync_timer_elapsed32(g_rgb_timer) >= interval && rgb_matrix_driver_ready()) rgb_task_state = STARTING;
 }
 
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
+#ifdef RGB_MATRIX_ADAPTIVE_FRAME_RATE
+    rgb_last_config = rgb_matrix_config;
+#endif  // RGB_MATRIX_ADAPTIVE_FRAME_RATE
+
+#ifdef RGB_MATRIX_COMPOSITOR
+    // indicators are redrawn every frame
+    rgb_matrix_layer_clear(RGB_MATRIX_LAYER_INDICATOR);
+#endif  // RGB_MATRIX_COMPOSITOR
 
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
@@ -334,34 +451,29 @@ static void rgb_task_start(void) {
     rgb_task_state = RENDERING;
 }
 
-static void rgb_task_render(uint8_t effect) {
-    bool rendering         = false;
-    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
-    if (rgb_effect_params.flags != rgb_matrix_config.flags) {
-        rgb_effect_params.flags = rgb_matrix_config.flags;
-        rgb_matrix_set_color_all(0, 0, 0);
-    }
+static bool rgb_matrix_run_effect(uint8_t effect, effect_params_t *params) {
+    bool rendering = false;
 
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
     switch (effect) {
         case RGB_MATRIX_NONE:
-            rendering = rgb_matrix_none(&rgb_effect_params);
+            rendering = rgb_matrix_none(params);
             break;
 
 // ---------------------------------------------
 // -----Begin rgb effect switch case macros-----
-#define RGB_MATRIX_EFFECT(name, ...)          \
-    case RGB_MATRIX_##name:                   \
-        rendering = name(&rgb_effect_params); \
+#define RGB_MATRIX_EFFECT(name, ...) \
+    case RGB_MATRIX_##name:          \
+        rendering = name(params);    \
         break;
 #include "rgb_matrix_effects.inc"
 #undef RGB_MATRIX_EFFECT
 
 #if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
-#    define RGB_MATRIX_EFFECT(name, ...)          \
-        case RGB_MATRIX_CUSTOM_##name:            \
-            rendering = name(&rgb_effect_params); \
+#    define RGB_MATRIX_EFFECT(name, ...) \
+        case RGB_MATRIX_CUSTOM_##name:   \
+            rendering = name(params);    \
             break;
 #    ifdef RGB_MATRIX_CUSTOM_KB
 #        include "rgb_matrix_kb.inc"
@@ -373,19 +485,54 @@ static void rgb_task_render(uint8_t effect) {
 #endif
             // -----End rgb effect switch case macros-------
             // ---------------------------------------------
+    }
 
-        // Factory default magic value
-        case UINT8_MAX: {
-            rgb_matrix_test();
-            rgb_task_state = FLUSHING;
-        }
-            return;
+    return rendering;
+}
+
+#ifdef RGB_MATRIX_COMPOSITOR
+static void rgb_task_render_overlay(void) {
+    if (rgb_overlay_effect == RGB_MATRIX_NONE) return;
+
+    rgb_overlay_params.iter  = 0;
+    rgb_overlay_params.init  = rgb_overlay_effect != rgb_last_overlay_effect;
+    rgb_overlay_params.flags = rgb_effect_params.flags;
+
+    // overlays are rendered in one go once the base effect is done with the frame
+    rgb_matrix_layer_select(RGB_MATRIX_LAYER_REACTIVE);
+    while (rgb_matrix_run_effect(rgb_overlay_effect, &rgb_overlay_params)) {
+        rgb_overlay_params.iter++;
     }
+    rgb_matrix_layer_select(RGB_MATRIX_LAYER_BASE);
+
+    rgb_last_overlay_effect = rgb_overlay_effect;
+}
+#endif  // RGB_MATRIX_COMPOSITOR
+
+static void rgb_task_render(uint8_t effect) {
+    bool rendering         = false;
+    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
+    if (rgb_effect_params.flags != rgb_matrix_config.flags) {
+        rgb_effect_params.flags = rgb_matrix_config.flags;
+        rgb_matrix_set_color_all(0, 0, 0);
+    }
+
+    // Factory default magic value
+    if (effect == UINT8_MAX) {
+        rgb_matrix_test();
+        rgb_task_state = FLUSHING;
+        return;
+    }
+
+    rendering = rgb_matrix_run_effect(effect, &rgb_effect_params);
 
     rgb_effect_params.iter++;
 
     // next task
     if (!rendering) {
+#ifdef RGB_MATRIX_COMPOSITOR
+        if (effect != RGB_MATRIX_NONE) rgb_task_render_overlay();
+#endif  // RGB_MATRIX_COMPOSITOR
         rgb_task_state = FLUSHING;
         if (!rgb_effect_params.init && effect == RGB_MATRIX_NONE) {
             // We only need to flush once if we are RGB_MATRIX_NONE
@@ -399,6 +546,21 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_last_effect = effect;
     rgb_last_enable = rgb_matrix_config.enable;
 
+#ifdef RGB_MATRIX_COMPOSITOR
+    // overlays and indicators only show on top of a running effect
+    if (effect == RGB_MATRIX_NONE) {
+        rgb_matrix_layer_clear(RGB_MATRIX_LAYER_REACTIVE);
+        rgb_matrix_layer_clear(RGB_MATRIX_LAYER_INDICATOR);
+        rgb_last_overlay_effect = RGB_MATRIX_NONE;
+    }
+
+    // the driver only sees the composited frame
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        RGB color = rgb_matrix_compositor_blend(i);
+        rgb_matrix_write_color(i, color.r, color.g, color.b);
+    }
+#endif  // RGB_MATRIX_COMPOSITOR
+
     // update pwm buffers
     rgb_matrix_update_pwm_buffers();
 
@@ -426,15 +588,21 @@ void rgb_matrix_task(void) {
         case RENDERING:
             rgb_task_render(effect);
             if (effect) {
+#ifdef RGB_MATRIX_COMPOSITOR
+                rgb_matrix_layer_select(RGB_MATRIX_LAYER_INDICATOR);
+#endif  // RGB_MATRIX_COMPOSITOR
                 rgb_matrix_indicators();
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
+#ifdef RGB_MATRIX_COMPOSITOR
+                rgb_matrix_layer_select(RGB_MATRIX_LAYER_BASE);
+#endif  // RGB_MATRIX_COMPOSITOR
             }
             break;
         case FLUSHING:
             rgb_task_flush(effect);
             break;
         case SYNCING:
-            rgb_task_sync();
+            rgb_task_sync(effect);
             break;
     }
 }
@@ -562,6 +730,20 @@ void rgb_matrix_mode(uint8_t mode) { rgb_matrix_mode_eeprom_helper(mode, true);
 
 uint8_t rgb_matrix_get_mode(void) { return rgb_matrix_config.mode; }
 
+#ifdef RGB_MATRIX_COMPOSITOR
+void rgb_matrix_set_overlay_mode_noeeprom(uint8_t mode) {
+    rgb_overlay_effect = mode < RGB_MATRIX_EFFECT_MAX ? mode : RGB_MATRIX_NONE;
+    if (rgb_overlay_effect == RGB_MATRIX_NONE) {
+        rgb_matrix_layer_clear(RGB_MATRIX_LAYER_REACTIVE);
+        rgb_last_overlay_effect = RGB_MATRIX_NONE;
+    }
+    rgb_task_state = STARTING;
+    dprintf("rgb matrix overlay mode [NOEEPROM]: %u\n", rgb_overlay_effect);
+}
+
+uint8_t rgb_matrix_get_overlay_mode(void) { return rgb_overlay_effect; }
+#endif  // RGB_MATRIX_COMPOSITOR
+
 void rgb_matrix_step_helper(bool write_to_eeprom) {
     uint8_t mode = rgb_matrix_config.mode + 1;
     rgb_matrix_mode_eeprom_helper((mode < RGB_MATRIX_EFFECT_MAX) ? mode : 1, write_to_eeprom);
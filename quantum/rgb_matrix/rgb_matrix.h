@@ -24,6 +24,9 @@
 #include "color.h"
 #include "quantum.h"
 #include "rgb_matrix_legacy_enables.h"
+#ifdef RGB_MATRIX_COMPOSITOR
+#    include "rgb_matrix_compositor.h"
+#endif
 
 #ifdef IS31FL3731
 #    include "is31fl3731.h"
@@ -47,6 +50,15 @@
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
 
+#ifdef RGB_MATRIX_ADAPTIVE_FRAME_RATE
+#    ifndef RGB_MATRIX_IDLE_FLUSH_LIMIT
+#        define RGB_MATRIX_IDLE_FLUSH_LIMIT 250
+#    endif
+#    ifndef RGB_MATRIX_KEYPRESS_BOOST
+#        define RGB_MATRIX_KEYPRESS_BOOST 250
+#    endif
+#endif
+
 #if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
 #    define RGB_MATRIX_USE_LIMITS(min, max)                        \
         uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter; \
@@ -160,6 +172,11 @@ void        rgb_matrix_decrease_speed_noeeprom(void);
 led_flags_t rgb_matrix_get_flags(void);
 void        rgb_matrix_set_flags(led_flags_t flags);
 
+#ifdef RGB_MATRIX_COMPOSITOR
+void    rgb_matrix_set_overlay_mode_noeeprom(uint8_t mode);
+uint8_t rgb_matrix_get_overlay_mode(void);
+#endif
+
 #ifndef RGBLIGHT_ENABLE
 #    define eeconfig_update_rgblight_current eeconfig_update_rgb_matrix
 #    define rgblight_toggle rgb_matrix_toggle
@@ -212,6 +229,8 @@ typedef struct {
     void (*set_color_all)(uint8_t r, uint8_t g, uint8_t b);
     /* Flush any buffered changes to the hardware. */
     void (*flush)(void);
+    /* Optional: return false while the hardware cannot accept another frame yet. */
+    bool (*ready)(void);
 } rgb_matrix_driver_t;
 
 extern const rgb_matrix_driver_t rgb_matrix_driver;
@@ -0,0 +1,104 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rgb_matrix.h"
+#include <string.h>
+
+#include <lib/lib8tion/lib8tion.h>
+
+#ifdef RGB_MATRIX_COMPOSITOR
+
+#    define LAYER_MASK_SIZE ((DRIVER_LED_TOTAL + 7) / 8)
+
+typedef struct {
+    RGB                color[DRIVER_LED_TOTAL];
+    uint8_t            mask[LAYER_MASK_SIZE];  // LEDs which have been written since the last clear
+    rgb_matrix_blend_t blend;
+    uint8_t            alpha;
+    bool               used;  // any bit set in mask
+} rgb_matrix_layer_buffer_t;
+
+static rgb_matrix_layer_buffer_t layers[RGB_MATRIX_LAYER_COUNT] = {
+    [RGB_MATRIX_LAYER_BASE]      = {.blend = RGB_MATRIX_BLEND_NORMAL, .alpha = UINT8_MAX},
+    [RGB_MATRIX_LAYER_REACTIVE]  = {.blend = RGB_MATRIX_BLEND_ADD, .alpha = UINT8_MAX},
+    [RGB_MATRIX_LAYER_INDICATOR] = {.blend = RGB_MATRIX_BLEND_NORMAL, .alpha = UINT8_MAX},
+};
+static rgb_matrix_layer_t selected_layer = RGB_MATRIX_LAYER_BASE;
+
+void rgb_matrix_layer_select(rgb_matrix_layer_t layer) {
+    if (layer < RGB_MATRIX_LAYER_COUNT) selected_layer = layer;
+}
+
+rgb_matrix_layer_t rgb_matrix_layer_get_selected(void) { return selected_layer; }
+
+void rgb_matrix_layer_set_blend(rgb_matrix_layer_t layer, rgb_matrix_blend_t blend, uint8_t alpha) {
+    // the base layer has nothing below it to blend with
+    if (layer == RGB_MATRIX_LAYER_BASE || layer >= RGB_MATRIX_LAYER_COUNT) return;
+    layers[layer].blend = blend;
+    layers[layer].alpha = alpha;
+}
+
+void rgb_matrix_layer_clear(rgb_matrix_layer_t layer) {
+    if (layer == RGB_MATRIX_LAYER_BASE || layer >= RGB_MATRIX_LAYER_COUNT || !layers[layer].used) return;
+    memset(layers[layer].mask, 0, sizeof(layers[layer].mask));
+    layers[layer].used = false;
+}
+
+void rgb_matrix_compositor_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index < 0 || index >= DRIVER_LED_TOTAL) return;
+
+    rgb_matrix_layer_buffer_t *layer = &layers[selected_layer];
+    layer->color[index]              = (RGB){.r = red, .g = green, .b = blue};
+    layer->mask[index / 8] |= 1 << (index % 8);
+    layer->used = true;
+}
+
+void rgb_matrix_compositor_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+    rgb_matrix_layer_buffer_t *layer = &layers[selected_layer];
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        layer->color[i] = (RGB){.r = red, .g = green, .b = blue};
+    }
+    memset(layer->mask, UINT8_MAX, sizeof(layer->mask));
+    layer->used = true;
+}
+
+static inline uint8_t blend_channel(uint8_t below, uint8_t above, rgb_matrix_blend_t blend, uint8_t alpha) {
+    switch (blend) {
+        case RGB_MATRIX_BLEND_ADD:
+            return qadd8(below, scale8(above, alpha));
+        case RGB_MATRIX_BLEND_MULTIPLY:
+            return blend8(below, scale8(below, above), alpha);
+        default:
+            return blend8(below, above, alpha);
+    }
+}
+
+RGB rgb_matrix_compositor_blend(uint8_t index) {
+    RGB color = layers[RGB_MATRIX_LAYER_BASE].color[index];
+
+    for (uint8_t i = RGB_MATRIX_LAYER_BASE + 1; i < RGB_MATRIX_LAYER_COUNT; i++) {
+        rgb_matrix_layer_buffer_t *layer = &layers[i];
+        if (!layer->used || !layer->alpha || !(layer->mask[index / 8] & (1 << (index % 8)))) continue;
+
+        RGB above = layer->color[index];
+        color.r   = blend_channel(color.r, above.r, layer->blend, layer->alpha);
+        color.g   = blend_channel(color.g, above.g, layer->blend, layer->alpha);
+        color.b   = blend_channel(color.b, above.b, layer->blend, layer->alpha);
+    }
+    return color;
+}
+
+#endif  // RGB_MATRIX_COMPOSITOR
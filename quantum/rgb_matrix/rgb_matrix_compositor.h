@@ -0,0 +1,51 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "color.h"
+
+/* Layers are composited bottom to top when the frame is flushed. */
+typedef enum rgb_matrix_layer_t {
+    RGB_MATRIX_LAYER_BASE,       // the current effect, always opaque
+    RGB_MATRIX_LAYER_REACTIVE,   // the overlay effect, see rgb_matrix_set_overlay_mode_noeeprom()
+    RGB_MATRIX_LAYER_INDICATOR,  // written by the indicator callbacks, cleared every frame
+    RGB_MATRIX_LAYER_COUNT
+} rgb_matrix_layer_t;
+
+typedef enum rgb_matrix_blend_t {
+    RGB_MATRIX_BLEND_NORMAL,    // replace what is below
+    RGB_MATRIX_BLEND_ADD,       // add to what is below, black is transparent
+    RGB_MATRIX_BLEND_MULTIPLY,  // scale what is below, white is transparent
+} rgb_matrix_blend_t;
+
+/* Select the layer rgb_matrix_set_color() and rgb_matrix_set_color_all() write to. */
+void               rgb_matrix_layer_select(rgb_matrix_layer_t layer);
+rgb_matrix_layer_t rgb_matrix_layer_get_selected(void);
+
+/* Set how a layer is blended onto the ones below it, and its opacity (0-255). */
+void rgb_matrix_layer_set_blend(rgb_matrix_layer_t layer, rgb_matrix_blend_t blend, uint8_t alpha);
+
+/* Make every LED of a layer transparent again. */
+void rgb_matrix_layer_clear(rgb_matrix_layer_t layer);
+
+void rgb_matrix_compositor_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
+void rgb_matrix_compositor_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
+
+/* The final colour of an LED, with all layers blended. */
+RGB rgb_matrix_compositor_blend(uint8_t index);
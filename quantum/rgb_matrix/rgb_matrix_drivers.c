@@ -248,5 +248,6 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
     .flush         = flush,
     .set_color     = setled,
     .set_color_all = setled_all,
+    .ready         = ws2812_ready,
 };
 #endif
@@ -59,6 +59,13 @@ typedef struct PACKED {
     bool        init;
 } effect_params_t;
 
+/* How often an effect needs to be redrawn, see RGB_MATRIX_ADAPTIVE_FRAME_RATE. */
+typedef enum rgb_matrix_refresh_t {
+    RGB_MATRIX_REFRESH_ANIMATED,  // changes over time, at a rate set by the speed setting
+    RGB_MATRIX_REFRESH_STATIC,    // only changes when the config does
+    RGB_MATRIX_REFRESH_REACTIVE,  // only changes while a keypress fades out
+} rgb_matrix_refresh_t;
+
 typedef struct PACKED {
     uint8_t x;
     uint8_t y;
@@ -130,6 +130,30 @@ rgblight_segment_t const *const *rgblight_layers = NULL;
 
 rgblight_ranges_t rgblight_ranges = {0, RGBLED_NUM, 0, RGBLED_NUM, RGBLED_NUM};
 
+// Moving effects keep a table of their colours and only rewrite the LEDs that changed since
+// their last step, as long as nothing else wrote to the buffer in between. RGBW converts the
+// buffer in place and custom drivers bypass rgblight_set(), so both always redraw everything.
+#if defined(RGBLIGHT_EFFECT_BREATHING) || defined(RGBLIGHT_EFFECT_SNAKE) || defined(RGBLIGHT_EFFECT_KNIGHT)
+#    if !defined(RGBLIGHT_CUSTOM_DRIVER) && !defined(RGBW)
+#        define RGBLIGHT_EFFECT_PARTIAL_UPDATE
+#    endif
+#    ifdef RGBLIGHT_EFFECT_SNAKE
+#        define RGBLIGHT_EFFECT_PALETTE_SIZE RGBLIGHT_EFFECT_SNAKE_LENGTH
+#    else
+#        define RGBLIGHT_EFFECT_PALETTE_SIZE 1
+#    endif
+
+static struct {
+    uint8_t  mode;
+    HSV      hsv;
+    uint8_t  start_pos;
+    uint8_t  num_leds;
+    bool     valid;   // led[] holds the last step drawn with this palette
+    bool     drawing; // the next rgblight_set() is an animation step
+    LED_TYPE color[RGBLIGHT_EFFECT_PALETTE_SIZE];  // full brightness fading out to 1 / size
+} effect_palette;
+#endif
+
 void rgblight_set_clipping_range(uint8_t start_pos, uint8_t num_leds) {
     rgblight_ranges.clipping_start_pos = start_pos;
     rgblight_ranges.clipping_num_leds  = num_leds;
@@ -178,7 +202,7 @@ void rgblight_check_config(void) {
 
 uint32_t eeconfig_read_rgblight(void) {
 #ifdef EEPROM_ENABLE
-    return eeprom_read_dword(EECONFIG_RGBLIGHT);
+    return eeconfig_read_dword(EECONFIG_RGBLIGHT);
 #else
     return 0;
 #endif
@@ -187,7 +211,7 @@ uint32_t eeconfig_read_rgblight(void) {
 void eeconfig_update_rgblight(uint32_t val) {
 #ifdef EEPROM_ENABLE
     rgblight_check_config();
-    eeprom_update_dword(EECONFIG_RGBLIGHT, val);
+    eeconfig_update_dword(EECONFIG_RGBLIGHT, val);
 #endif
 }
 
@@ -666,6 +690,10 @@ void rgblight_set_layer_state(uint8_t layer, bool enabled) {
         rgblight_status.enabled_layer_mask &= ~mask;
     }
     RGBLIGHT_SPLIT_SET_CHANGE_LAYERS;
+#    ifdef RGBLIGHT_EFFECT_PARTIAL_UPDATE
+    // the next animation step has to redraw whatever the layer covered
+    effect_palette.valid = false;
+#    endif
     // Static modes don't have a ticker running to update the LEDs
     if (rgblight_status.timer_enabled == false) {
         rgblight_mode_noeeprom(rgblight_config.mode);
@@ -798,12 +826,27 @@ void rgblight_wakeup(void) {
 
 __attribute__((weak)) void rgblight_call_driver(LED_TYPE *start_led, uint8_t num_leds) { ws2812_setleds(start_led, num_leds); }
 
+// Animations hold off stepping while this returns false, so frames are not handed to a busy driver
+__attribute__((weak)) bool rgblight_driver_ready(void) {
+#ifndef RGBLIGHT_CUSTOM_DRIVER
+    return ws2812_ready();
+#else
+    return true;
+#endif
+}
+
 #ifndef RGBLIGHT_CUSTOM_DRIVER
 
 void rgblight_set(void) {
     LED_TYPE *start_led;
     uint8_t   num_leds = rgblight_ranges.clipping_num_leds;
 
+#    ifdef RGBLIGHT_EFFECT_PARTIAL_UPDATE
+    // anything other than an animation step leaves the buffer in an unknown state
+    effect_palette.valid   = effect_palette.drawing && rgblight_config.enable;
+    effect_palette.drawing = false;
+#    endif
+
     if (!rgblight_config.enable) {
         for (uint8_t i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
             led[i].r = 0;
@@ -824,6 +867,9 @@ void rgblight_set(void) {
 #        endif
     ) {
         rgblight_layers_write();
+#        ifdef RGBLIGHT_EFFECT_PARTIAL_UPDATE
+        if (rgblight_status.enabled_layer_mask) effect_palette.valid = false;
+#        endif
     }
 #    endif
 
@@ -1019,7 +1065,7 @@ void rgblight_task(void) {
             animation_status.pos16      = 0;  // restart signal to local each effect
         }
         uint16_t now = sync_timer_read();
-        if (timer_expired(now, animation_status.last_timer)) {
+        if (timer_expired(now, animation_status.last_timer) && rgblight_driver_ready()) {
 #    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
             static uint16_t report_last_timer = 0;
             static bool     tick_flag         = false;
@@ -1071,15 +1117,51 @@ static uint8_t breathe_calc(uint8_t pos) {
 
 #endif
 
+#ifdef RGBLIGHT_EFFECT_PALETTE_SIZE
+/* Recalculates the colour table when the mode, colour or effect range changed. Returns true
+ * if the previous animation step is still in the buffer and can be updated in place. */
+static bool rgblight_effect_palette_update(void) {
+    if (effect_palette.mode != rgblight_config.mode || effect_palette.hsv.h != rgblight_config.hue || effect_palette.hsv.s != rgblight_config.sat || effect_palette.hsv.v != rgblight_config.val || effect_palette.start_pos != rgblight_ranges.effect_start_pos || effect_palette.num_leds != rgblight_ranges.effect_num_leds) {
+        effect_palette.mode      = rgblight_config.mode;
+        effect_palette.hsv       = (HSV){rgblight_config.hue, rgblight_config.sat, rgblight_config.val};
+        effect_palette.start_pos = rgblight_ranges.effect_start_pos;
+        effect_palette.num_leds  = rgblight_ranges.effect_num_leds;
+        effect_palette.valid     = false;
+        for (uint8_t j = 0; j < RGBLIGHT_EFFECT_PALETTE_SIZE; j++) {
+            sethsv(rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_PALETTE_SIZE - j) / RGBLIGHT_EFFECT_PALETTE_SIZE), &effect_palette.color[j]);
+        }
+    }
+    effect_palette.drawing = true;
+    return effect_palette.valid;
+}
+
+static inline void rgblight_effect_clear(uint8_t index) {
+    led[index].r = 0;
+    led[index].g = 0;
+    led[index].b = 0;
+#    ifdef RGBW
+    led[index].w = 0;
+#    endif
+}
+#endif
+
 // Effects
 #ifdef RGBLIGHT_EFFECT_BREATHING
 
 __attribute__((weak)) const uint8_t RGBLED_BREATHING_INTERVALS[] PROGMEM = {30, 20, 10, 5};
 
 void rgblight_effect_breathing(animation_status_t *anim) {
-    uint8_t val = breathe_calc(anim->pos);
+    static uint8_t last_val;
+    uint8_t        val = breathe_calc(anim->pos);
+    anim->pos          = (anim->pos + 1);
+
+    // the curve is flat around its peak, steps that come out the same don't need sending
+    if (rgblight_effect_palette_update() && val == last_val) {
+        effect_palette.drawing = false;
+        return;
+    }
+    last_val = val;
     rgblight_sethsv_noeeprom_old(rgblight_config.hue, rgblight_config.sat, val);
-    anim->pos = (anim->pos + 1);
 }
 #endif
 
@@ -1122,6 +1204,8 @@ __attribute__((weak)) const uint8_t RGBLED_SNAKE_INTERVALS[] PROGMEM = {100, 50,
 
 void rgblight_effect_snake(animation_status_t *anim) {
     static uint8_t pos = 0;
+    static uint8_t lit[RGBLIGHT_EFFECT_SNAKE_LENGTH];
+    static uint8_t lit_count = 0;
     uint8_t        i, j;
     int8_t         k;
     int8_t         increment = 1;
@@ -1141,25 +1225,28 @@ void rgblight_effect_snake(animation_status_t *anim) {
     }
 #    endif
 
-    for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        LED_TYPE *ledp = led + i + rgblight_ranges.effect_start_pos;
-        ledp->r        = 0;
-        ledp->g        = 0;
-        ledp->b        = 0;
-#    ifdef RGBW
-        ledp->w = 0;
-#    endif
-        for (j = 0; j < RGBLIGHT_EFFECT_SNAKE_LENGTH; j++) {
-            k = pos + j * increment;
-            if (k > RGBLED_NUM) {
-                k = k % RGBLED_NUM;
-            }
-            if (k < 0) {
-                k = k + rgblight_ranges.effect_num_leds;
-            }
-            if (i == k) {
-                sethsv(rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH), ledp);
-            }
+    if (rgblight_effect_palette_update()) {
+        // only the LEDs lit by the last step can have changed
+        for (i = 0; i < lit_count; i++) {
+            rgblight_effect_clear(lit[i]);
+        }
+    } else {
+        for (i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
+            rgblight_effect_clear(i);
+        }
+    }
+    lit_count = 0;
+    for (j = 0; j < RGBLIGHT_EFFECT_SNAKE_LENGTH; j++) {
+        k = pos + j * increment;
+        if (k > RGBLED_NUM) {
+            k = k % RGBLED_NUM;
+        }
+        if (k < 0) {
+            k = k + rgblight_ranges.effect_num_leds;
+        }
+        if (k >= 0 && k < rgblight_ranges.effect_num_leds) {
+            led[k + rgblight_ranges.effect_start_pos] = effect_palette.color[j];
+            lit[lit_count++]                          = k + rgblight_ranges.effect_start_pos;
         }
     }
     rgblight_set();
@@ -1188,10 +1275,12 @@ void rgblight_effect_snake(animation_status_t *anim) {
 __attribute__((weak)) const uint8_t RGBLED_KNIGHT_INTERVALS[] PROGMEM = {127, 63, 31};
 
 void rgblight_effect_knight(animation_status_t *anim) {
-    static int8_t low_bound  = 0;
-    static int8_t high_bound = RGBLIGHT_EFFECT_KNIGHT_LENGTH - 1;
-    static int8_t increment  = 1;
-    uint8_t       i, cur;
+    static int8_t  low_bound  = 0;
+    static int8_t  high_bound = RGBLIGHT_EFFECT_KNIGHT_LENGTH - 1;
+    static int8_t  increment  = 1;
+    static uint8_t lit[RGBLIGHT_EFFECT_KNIGHT_LENGTH];
+    static uint8_t lit_count = 0;
+    uint8_t        i;
 
 #    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
     if (anim->pos == 0) {  // restart signal
@@ -1201,29 +1290,23 @@ void rgblight_effect_knight(animation_status_t *anim) {
         increment  = 1;
     }
 #    endif
-    // Set all the LEDs to 0
-    for (i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
-        led[i].r = 0;
-        led[i].g = 0;
-        led[i].b = 0;
-#    ifdef RGBW
-        led[i].w = 0;
-#    endif
-    }
-    // Determine which LEDs should be lit up
-    for (i = 0; i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM; i++) {
-        cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % rgblight_ranges.effect_num_leds + rgblight_ranges.effect_start_pos;
-
-        if (i >= low_bound && i <= high_bound) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[cur]);
-        } else {
-            led[cur].r = 0;
-            led[cur].g = 0;
-            led[cur].b = 0;
-#    ifdef RGBW
-            led[cur].w = 0;
-#    endif
+    if (rgblight_effect_palette_update()) {
+        // Only the LEDs lit by the last step can have changed
+        for (i = 0; i < lit_count; i++) {
+            rgblight_effect_clear(lit[i]);
         }
+    } else {
+        // Set all the LEDs to 0
+        for (i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
+            rgblight_effect_clear(i);
+        }
+    }
+    // Light up the LEDs between the bounds
+    lit_count = 0;
+    for (int16_t pos = MAX(low_bound, 0); pos <= high_bound && pos < RGBLIGHT_EFFECT_KNIGHT_LED_NUM; pos++) {
+        uint8_t cur      = (pos + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % rgblight_ranges.effect_num_leds + rgblight_ranges.effect_start_pos;
+        led[cur]         = effect_palette.color[0];
+        lit[lit_count++] = cur;
     }
     rgblight_set();
 
@@ -0,0 +1,160 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scan_profiler.h"
+#include "timer.h"
+#include "print.h"
+#include <string.h>
+
+#if defined(__AVR__)
+#    include <util/atomic.h>
+#    if defined(__AVR_ATmega32A__)
+#        define TIMER_COMPARE_PENDING() (TIFR & _BV(OCF0))
+#    elif defined(__AVR_ATtiny85__)
+#        define TIMER_COMPARE_PENDING() (TIFR & _BV(OCF0A))
+#    else
+#        define TIMER_COMPARE_PENDING() (TIFR0 & _BV(OCF0A))
+#    endif
+
+extern volatile uint32_t timer_count;
+#endif
+
+// Histogram of half octaves: bucket 2n covers [2^n, 1.5 * 2^n), bucket 2n + 1 [1.5 * 2^n, 2^(n+1))
+#if defined(__AVR__)
+#    define SCAN_PROFILER_BUCKETS (2 * 20)  // longer than 2^20 cycles lands in the last bucket
+typedef uint32_t scan_profiler_sum_t;
+#else
+#    define SCAN_PROFILER_BUCKETS (2 * 32)
+typedef uint64_t scan_profiler_sum_t;
+#endif
+
+typedef struct {
+    uint32_t            count;
+    uint32_t            min;
+    uint32_t            max;
+    scan_profiler_sum_t sum;
+    uint16_t            buckets[SCAN_PROFILER_BUCKETS];
+} scan_phase_profile_t;
+
+static scan_phase_profile_t profiles[SCAN_PHASE_COUNT];
+
+#ifndef NO_PRINT
+static const char *phase_names[SCAN_PHASE_COUNT] = {
+    [SCAN_PHASE_TOTAL] = "total", [SCAN_PHASE_MATRIX] = "matrix_scan", [SCAN_PHASE_DEBOUNCE] = "debounce", [SCAN_PHASE_COMBO] = "combo", [SCAN_PHASE_TAP_DANCE] = "tap_dance", [SCAN_PHASE_ACTION] = "action", [SCAN_PHASE_HOST_SEND] = "host_send", [SCAN_PHASE_LIGHTING] = "lighting", [SCAN_PHASE_ENCODER] = "encoder", [SCAN_PHASE_DISPLAY] = "display", [SCAN_PHASE_MOUSE] = "mouse", [SCAN_PHASE_POINTING] = "pointing",
+};
+#endif
+
+static inline uint8_t bucket_for(uint32_t cycles) {
+    if (cycles < 2) return cycles;
+    uint8_t msb = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(cycles);
+    return 2 * msb + ((cycles >> (msb - 1)) & 1);
+}
+
+static inline uint32_t bucket_start(uint8_t bucket) {
+    if (bucket < 2) return bucket;
+    uint8_t msb = bucket / 2;
+    return (1UL << msb) | ((uint32_t)(bucket & 1) << (msb - 1));
+}
+
+#if defined(__AVR__)
+scan_profiler_ticks_t scan_profiler_now(void) {
+    uint32_t t;
+    uint8_t  raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t   = timer_count;
+        raw = TIMER_RAW;
+        // as in timer_read_us(), Timer0 has wrapped but the interrupt hasn't run yet
+        if (TIMER_COMPARE_PENDING() && raw < TIMER_RAW_TOP / 2) {
+            t++;
+        }
+    }
+
+    return t * (TIMER_RAW_TOP + 1) + raw;
+}
+#endif
+
+void scan_profiler_init(void) {
+#if defined(PROTOCOL_CHIBIOS)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    scan_profiler_reset();
+}
+
+void scan_profiler_record(scan_phase_t phase, scan_profiler_ticks_t ticks) {
+    scan_phase_profile_t *profile = &profiles[phase];
+    uint32_t              cycles  = (uint32_t)ticks * SCAN_PROFILER_CYCLES_PER_TICK;
+
+    if (!profile->count || cycles < profile->min) profile->min = cycles;
+    if (cycles > profile->max) profile->max = cycles;
+    profile->sum += cycles;
+    profile->count++;
+
+    uint8_t bucket = bucket_for(cycles);
+    if (bucket >= SCAN_PROFILER_BUCKETS) bucket = SCAN_PROFILER_BUCKETS - 1;
+    if (profile->buckets[bucket] < UINT16_MAX) profile->buckets[bucket]++;
+}
+
+void scan_profiler_get(scan_phase_t phase, scan_phase_stats_t *stats) {
+    const scan_phase_profile_t *profile = &profiles[phase];
+
+    memset(stats, 0, sizeof(*stats));
+    if (!profile->count) return;
+
+    stats->count = profile->count;
+    stats->min   = profile->min;
+    stats->max   = profile->max;
+    stats->avg   = profile->sum / profile->count;
+
+    // end of the bucket holding the 99th percentile, counted from the top as buckets can saturate
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < SCAN_PROFILER_BUCKETS; i++) total += profile->buckets[i];
+    uint32_t remaining = total - (total * 99 + 99) / 100 + 1;
+    uint8_t  bucket    = SCAN_PROFILER_BUCKETS - 1;
+    while (bucket && profile->buckets[bucket] < remaining) {
+        remaining -= profile->buckets[bucket];
+        bucket--;
+    }
+    stats->p99 = bucket + 1 < SCAN_PROFILER_BUCKETS ? bucket_start(bucket + 1) - 1 : profile->max;
+    if (stats->p99 > stats->max) stats->p99 = stats->max;
+    if (stats->p99 < stats->min) stats->p99 = stats->min;
+}
+
+void scan_profiler_reset(void) { memset(profiles, 0, sizeof(profiles)); }
+
+void scan_profiler_print(void) {
+#ifndef NO_PRINT
+    for (uint8_t phase = 0; phase < SCAN_PHASE_COUNT; phase++) {
+        scan_phase_stats_t stats;
+        scan_profiler_get(phase, &stats);
+        if (!stats.count) continue;
+        uprintf("scan profile %s: n=%lu min=%lu avg=%lu p99=%lu max=%lu cycles\n", phase_names[phase], stats.count, stats.min, stats.avg, stats.p99, stats.max);
+    }
+#endif
+}
+
+void scan_profiler_task(void) {
+#if SCAN_PROFILER_INTERVAL > 0
+    static uint32_t last_print = 0;
+    if (timer_elapsed32(last_print) >= SCAN_PROFILER_INTERVAL) {
+        last_print = timer_read32();
+        scan_profiler_print();
+        scan_profiler_reset();
+    }
+#endif
+}
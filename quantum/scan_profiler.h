@@ -0,0 +1,92 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Parts of keyboard_task() which are timed. Some are nested: matrix_scan includes debounce,
+ * combo and tap dance, action includes host_send.
+ */
+typedef enum {
+    SCAN_PHASE_TOTAL,
+    SCAN_PHASE_MATRIX,
+    SCAN_PHASE_DEBOUNCE,
+    SCAN_PHASE_COMBO,
+    SCAN_PHASE_TAP_DANCE,
+    SCAN_PHASE_ACTION,
+    SCAN_PHASE_HOST_SEND,
+    SCAN_PHASE_LIGHTING,
+    SCAN_PHASE_ENCODER,
+    SCAN_PHASE_DISPLAY,
+    SCAN_PHASE_MOUSE,
+    SCAN_PHASE_POINTING,
+    SCAN_PHASE_COUNT
+} scan_phase_t;
+
+/* All in CPU cycles, p99 is rounded up to the end of its half octave. */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t p99;
+    uint32_t max;
+} scan_phase_stats_t;
+
+// Milliseconds between printing (and resetting) the statistics on the console, 0 to only
+// collect them for scan_profiler_get()
+#ifndef SCAN_PROFILER_INTERVAL
+#    define SCAN_PROFILER_INTERVAL 5000
+#endif
+
+#ifdef SCAN_PROFILER_ENABLE
+
+#    if defined(__AVR__)
+#        include "avr/timer_avr.h"
+// Timer0, which already counts the milliseconds, read together with timer_count. It is only read,
+// so other features are free to use the remaining timers.
+typedef uint32_t scan_profiler_ticks_t;
+#        define SCAN_PROFILER_CYCLES_PER_TICK TIMER_PRESCALER
+scan_profiler_ticks_t scan_profiler_now(void);
+#    elif defined(PROTOCOL_CHIBIOS)
+#        include <hal.h>
+#        if !defined(DWT) || (__CORTEX_M < 3)
+#            error "The scan profiler needs the DWT cycle counter of a Cortex-M3 or newer"
+#        endif
+typedef uint32_t scan_profiler_ticks_t;
+#        define SCAN_PROFILER_CYCLES_PER_TICK 1
+static inline scan_profiler_ticks_t scan_profiler_now(void) { return DWT->CYCCNT; }
+#    else
+#        include "timer.h"
+typedef uint32_t scan_profiler_ticks_t;
+#        define SCAN_PROFILER_CYCLES_PER_TICK 1
+static inline scan_profiler_ticks_t scan_profiler_now(void) { return timer_read32(); }
+#    endif
+
+void scan_profiler_init(void);
+void scan_profiler_task(void);
+void scan_profiler_record(scan_phase_t phase, scan_profiler_ticks_t ticks);
+void scan_profiler_get(scan_phase_t phase, scan_phase_stats_t *stats);
+void scan_profiler_reset(void);
+void scan_profiler_print(void);
+
+#    define SCAN_PROFILE_BEGIN(phase) scan_profiler_ticks_t scan_profile_##phase = scan_profiler_now()
+#    define SCAN_PROFILE_END(phase) scan_profiler_record(phase, scan_profiler_now() - scan_profile_##phase)
+#else
+#    define SCAN_PROFILE_BEGIN(phase)
+#    define SCAN_PROFILE_END(phase)
+#endif
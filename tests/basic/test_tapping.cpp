@@ -95,3 +95,28 @@ TEST_F(Tapping, ANewTapWithinTappingTermIsBuggy) {
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT))).Times(1);
     idle_for(TAPPING_TERM);
 }
+
+TEST_F(Tapping, WaitingBufferOverflowHoldsTapKeyWithoutDroppingKeys) {
+    TestDriver driver;
+    InSequence s;
+    const int  taps = WAITING_BUFFER_SIZE;
+
+    // The buffer fills up before the tapping term ends, SFT_T is then taken as held
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    for (int i = 0; i < taps; i++) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+
+    press_key(7, 0);
+    run_one_scan_loop();
+    for (int i = 0; i < taps; i++) {
+        press_key(0, 0);
+        run_one_scan_loop();
+        release_key(0, 0);
+        run_one_scan_loop();
+    }
+    release_key(7, 0);
+    run_one_scan_loop();
+}
@@ -0,0 +1,414 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_common.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "keyboard.h"
+#include "keymap.h"
+#include "keystroke_trace.h"
+#include "timer.h"
+
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::InvokeWithoutArgs;
+
+// Replays keystroke traces through the whole pipeline and measures, for every matrix event,
+// how long it takes until a keyboard report goes out. Virtual time and scan counts are
+// deterministic, CPU time is measured on the host. Run with `make test:bench`, the results
+// are written as JSON to $QMK_BENCH_OUTPUT if that is set. A trace recorded
+// on a keyboard (see quantum/keystroke_trace.h) can be added with $QMK_BENCH_TRACE.
+
+#ifndef BENCH_ITERATIONS
+#    define BENCH_ITERATIONS 20
+#endif
+// events without a report after this many virtual ms are counted as unreported
+#ifndef BENCH_LATENCY_LIMIT
+#    define BENCH_LATENCY_LIMIT 1000
+#endif
+
+struct bench_event_t {
+    uint32_t delay;  // virtual ms since the previous event
+    uint8_t  col;
+    uint8_t  row;
+    bool     pressed;
+};
+
+typedef std::vector<bench_event_t> bench_trace_t;
+
+static const uint32_t latency_buckets[] = {0, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, BENCH_LATENCY_LIMIT};
+
+static std::vector<std::string> results;
+
+template <typename T>
+static std::string summary(std::vector<T> values) {
+    if (values.empty()) return "{\"count\":0}";
+
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (T value : values) sum += value;
+    size_t p99 = (values.size() * 99 + 99) / 100 - 1;
+
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"count\":%zu,\"min\":%llu,\"avg\":%.1f,\"p99\":%llu,\"max\":%llu}", values.size(), (unsigned long long)values.front(), sum / values.size(), (unsigned long long)values[p99], (unsigned long long)values.back());
+    return buf;
+}
+
+static std::string histogram(const std::vector<uint32_t> &latencies) {
+    std::string json = "[";
+    for (size_t i = 0; i < sizeof(latency_buckets) / sizeof(latency_buckets[0]); i++) {
+        uint32_t lower = i ? latency_buckets[i - 1] : 0;
+        size_t   count = std::count_if(latencies.begin(), latencies.end(), [&](uint32_t latency) { return (i == 0 || latency > lower) && latency <= latency_buckets[i]; });
+
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%s{\"le\":%u,\"count\":%zu}", i ? "," : "", (unsigned)latency_buckets[i], count);
+        json += buf;
+    }
+    return json + "]";
+}
+
+static bool find_key(uint16_t keycode, keypos_t *pos) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint16_t kc = keymap_key_to_keycode(0, (keypos_t){.col = col, .row = row});
+            if ((kc >= QK_MOD_TAP && kc <= QK_MOD_TAP_MAX) || (kc >= QK_LAYER_TAP && kc <= QK_LAYER_TAP_MAX)) {
+                kc &= 0xFF;
+            }
+            if (kc == keycode) {
+                *pos = (keypos_t){.col = col, .row = row};
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Someone typing `text` with a key every `interval` ms (give or take a bit) and holding each
+// for `hold` ms, so anything above `interval` rolls over into the next key.
+static bench_trace_t type_text(const char *text, uint16_t interval, uint16_t hold) {
+    struct timed_event_t {
+        uint32_t      time;
+        bench_event_t event;
+    };
+    std::vector<timed_event_t> events;
+
+    keypos_t shift;
+    find_key(KC_LSFT, &shift);
+
+    uint32_t seed = 1;
+    uint32_t now  = 0;
+    for (const char *c = text; *c; c++) {
+        uint16_t keycode = KC_NO;
+        bool     shifted = false;
+        if (*c >= 'a' && *c <= 'z') {
+            keycode = KC_A + (*c - 'a');
+        } else if (*c >= 'A' && *c <= 'Z') {
+            keycode = KC_A + (*c - 'A');
+            shifted = true;
+        } else if (*c == ' ') {
+            keycode = KC_SPC;
+        } else if (*c == ',') {
+            keycode = KC_COMM;
+        } else if (*c == '.') {
+            keycode = KC_DOT;
+        }
+
+        keypos_t pos;
+        if (!find_key(keycode, &pos)) continue;
+
+        seed = seed * 1103515245 + 12345;
+        now += interval - interval / 4 + (seed >> 16) % (interval / 2 + 1);
+        if (shifted) {
+            events.push_back({now - 30, {0, shift.col, shift.row, true}});
+            events.push_back({now + hold + 10, {0, shift.col, shift.row, false}});
+        }
+        events.push_back({now, {0, pos.col, pos.row, true}});
+        events.push_back({now + hold, {0, pos.col, pos.row, false}});
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const timed_event_t &a, const timed_event_t &b) { return a.time < b.time; });
+
+    bench_trace_t trace;
+    uint32_t      last = 0;
+    for (timed_event_t &timed : events) {
+        timed.event.delay = timed.time - last;
+        last              = timed.time;
+        trace.push_back(timed.event);
+    }
+    return trace;
+}
+
+static bench_trace_t load_trace(const char *path) {
+    bench_trace_t trace;
+    FILE *        file = fopen(path, "rb");
+    if (!file) return trace;
+
+    // keys outside the test matrix are dropped, their time still passes before the next event
+    uint32_t skipped = 0;
+    uint8_t  record[KEYSTROKE_TRACE_RECORD_SIZE];
+    while (fread(record, sizeof(record), 1, file) == 1) {
+        keystroke_trace_event_t event;
+        keystroke_trace_unpack(record, &event);
+        if (event.row < MATRIX_ROWS && event.col < MATRIX_COLS) {
+            trace.push_back({skipped + event.delta, event.col, event.row, event.pressed});
+            skipped = 0;
+        } else {
+            skipped += event.delta;
+        }
+    }
+    fclose(file);
+    return trace;
+}
+
+static const char *prose =
+    "The quick brown fox jumps over the lazy dog. Sphinx of black quartz, judge my vow. "
+    "Pack my box with five dozen liquor jugs. How vexingly quick daft zebras jump. "
+    "As she said, a sense of ease is seldom seen in a slow and sad assessment.";
+
+class Latency : public TestFixture {
+   public:
+    static void TearDownTestCase();
+
+   protected:
+    void run_trace(const char *name, const bench_trace_t &trace);
+};
+
+void Latency::TearDownTestCase() {
+    TestFixture::TearDownTestCase();
+
+    // keep ordinary test runs quiet, the traces are still checked for determinism
+    const char *path = getenv("QMK_BENCH_OUTPUT");
+    FILE *      out  = path ? fopen(path, "w") : NULL;
+    if (!out) {
+        if (path) fprintf(stderr, "Could not open %s\n", path);
+        results.clear();
+        return;
+    }
+
+    fprintf(out, "{\"iterations\":%d,\"latency_limit\":%d,\"traces\":[", BENCH_ITERATIONS, BENCH_LATENCY_LIMIT);
+    for (size_t i = 0; i < results.size(); i++) {
+        fprintf(out, "%s\n%s", i ? "," : "", results[i].c_str());
+    }
+    fprintf(out, "\n]}\n");
+
+    fclose(out);
+    results.clear();
+}
+
+void Latency::run_trace(const char *name, const bench_trace_t &trace) {
+    TestDriver driver;
+    bool       reported = false;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(InvokeWithoutArgs([&]() { reported = true; }));
+
+    struct pending_t {
+        uint32_t time;
+        uint32_t scans;
+        uint64_t cpu_ns;
+    };
+
+    std::vector<uint64_t> event_ns, scan_ns;
+    std::vector<uint32_t> scans, latencies, first_latencies;
+    uint32_t              unreported = 0;
+
+    for (int iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+        std::vector<pending_t> pending;
+        latencies.clear();
+
+        // start every pass on the same timer phase, as event times are rounded to odd values
+        advance_time(1024 - timer_read32() % 1024);
+
+        auto scan = [&]() {
+            auto start = std::chrono::steady_clock::now();
+            keyboard_task();
+            uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            scan_ns.push_back(elapsed);
+
+            for (pending_t &event : pending) {
+                event.scans++;
+                event.cpu_ns += elapsed;
+            }
+            if (reported) {
+                for (pending_t &event : pending) {
+                    latencies.push_back(timer_read32() - event.time);
+                    event_ns.push_back(event.cpu_ns);
+                    if (iteration == 0) scans.push_back(event.scans);
+                }
+                pending.clear();
+                reported = false;
+            }
+            auto expired = std::remove_if(pending.begin(), pending.end(), [](const pending_t &event) { return timer_read32() - event.time >= BENCH_LATENCY_LIMIT; });
+            if (iteration == 0) unreported += pending.end() - expired;
+            pending.erase(expired, pending.end());
+
+            advance_time(1);
+        };
+
+        for (const bench_event_t &event : trace) {
+            for (uint32_t i = 0; i < event.delay; i++) scan();
+            if (event.pressed) {
+                press_key(event.col, event.row);
+            } else {
+                release_key(event.col, event.row);
+            }
+            pending.push_back({timer_read32(), 0, 0});
+        }
+        while (!pending.empty()) scan();
+        idle_for(TAPPING_TERM + 10);
+
+        if (iteration == 0) {
+            first_latencies = latencies;
+        } else {
+            // virtual time doesn't depend on the host, so every pass has to agree
+            EXPECT_EQ(latencies, first_latencies) << "trace " << name << " is not deterministic";
+        }
+    }
+
+    std::string json = std::string("{\"name\":\"") + name + "\"";
+    json += ",\"events\":" + std::to_string(trace.size());
+    json += ",\"unreported\":" + std::to_string(unreported);
+    json += ",\"event_cpu_ns\":" + summary(event_ns);
+    json += ",\"scan_cpu_ns\":" + summary(scan_ns);
+    json += ",\"scans_to_report\":" + summary(scans);
+    json += ",\"latency_ms\":" + summary(first_latencies);
+    json += ",\"latency_histogram\":" + histogram(first_latencies);
+    results.push_back(json + "}");
+
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Latency, Prose) { run_trace("prose", type_text(prose, 150, 90)); }
+
+TEST_F(Latency, ProseRollover) { run_trace("prose_rollover", type_text(prose, 70, 110)); }
+
+TEST_F(Latency, HomeRowMods) {
+    run_trace("home_row_mods", {
+                                   // hold A past the tapping term for shift, then J
+                                   {0, 0, 1, true},
+                                   {250, 6, 1, true},
+                                   {50, 6, 1, false},
+                                   {30, 0, 1, false},
+                                   // roll A into S, both taps
+                                   {100, 0, 1, true},
+                                   {40, 1, 1, true},
+                                   {40, 0, 1, false},
+                                   {40, 1, 1, false},
+                                   // tap J inside a held S
+                                   {100, 1, 1, true},
+                                   {60, 6, 1, true},
+                                   {40, 6, 1, false},
+                                   {40, 1, 1, false},
+                               });
+}
+
+TEST_F(Latency, Layers) {
+    run_trace("layers", {
+                            // hold space for the number layer
+                            {0, 2, 3, true},
+                            {250, 0, 0, true},
+                            {40, 0, 0, false},
+                            {60, 1, 0, true},
+                            {40, 1, 0, false},
+                            {50, 2, 3, false},
+                            // tap space
+                            {100, 2, 3, true},
+                            {60, 2, 3, false},
+                            // arrows with MO(1)
+                            {100, 1, 3, true},
+                            {50, 5, 1, true},
+                            {40, 5, 1, false},
+                            {40, 8, 1, true},
+                            {40, 8, 1, false},
+                            {40, 1, 3, false},
+                        });
+}
+
+TEST_F(Latency, Combos) {
+    run_trace("combos", {
+                            // J+K for escape
+                            {0, 6, 1, true},
+                            {10, 7, 1, true},
+                            {60, 6, 1, false},
+                            {5, 7, 1, false},
+                            // D+F for tab
+                            {100, 2, 1, true},
+                            {5, 3, 1, true},
+                            {50, 3, 1, false},
+                            {10, 2, 1, false},
+                            // J on its own has to wait out the combo term
+                            {100, 6, 1, true},
+                            {80, 6, 1, false},
+                            // J then K too slowly to be a combo
+                            {100, 6, 1, true},
+                            {80, 7, 1, true},
+                            {40, 6, 1, false},
+                            {40, 7, 1, false},
+                        });
+}
+
+TEST_F(Latency, TapDance) {
+    run_trace("tap_dance", {
+                               // single tap for escape
+                               {0, 9, 2, true},
+                               {50, 9, 2, false},
+                               // double tap for caps lock, twice to leave it off
+                               {300, 9, 2, true},
+                               {50, 9, 2, false},
+                               {50, 9, 2, true},
+                               {50, 9, 2, false},
+                               {300, 9, 2, true},
+                               {50, 9, 2, false},
+                               {50, 9, 2, true},
+                               {50, 9, 2, false},
+                               // interrupted by another key
+                               {300, 9, 2, true},
+                               {50, 9, 2, false},
+                               {30, 0, 0, true},
+                               {40, 0, 0, false},
+                           });
+}
+
+TEST_F(Latency, KeyOverrides) {
+    run_trace("key_overrides", {
+                                   // shift + backspace for delete
+                                   {0, 0, 3, true},
+                                   {50, 9, 1, true},
+                                   {40, 9, 1, false},
+                                   {40, 9, 1, true},
+                                   {40, 9, 1, false},
+                                   {40, 0, 3, false},
+                                   // backspace on its own
+                                   {100, 9, 1, true},
+                                   {40, 9, 1, false},
+                               });
+}
+
+TEST_F(Latency, RecordedTrace) {
+    const char *path = getenv("QMK_BENCH_TRACE");
+    if (!path) return;
+
+    bench_trace_t trace = load_trace(path);
+    ASSERT_FALSE(trace.empty()) << "no events in " << path;
+    run_trace("recorded", trace);
+}
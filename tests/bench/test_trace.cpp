@@ -0,0 +1,101 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_common.hpp"
+#include <vector>
+
+extern "C" {
+#include "keystroke_trace.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+class KeystrokeTrace : public TestFixture {
+   protected:
+    void TearDown() override {
+        keystroke_trace_stop();
+        keystroke_trace_clear();
+    }
+};
+
+static std::vector<uint8_t> pack(const std::vector<keystroke_trace_event_t> &events) {
+    std::vector<uint8_t> trace(events.size() * KEYSTROKE_TRACE_RECORD_SIZE);
+    for (size_t i = 0; i < events.size(); i++) {
+        keystroke_trace_pack(&events[i], &trace[i * KEYSTROKE_TRACE_RECORD_SIZE]);
+    }
+    return trace;
+}
+
+TEST_F(KeystrokeTrace, NothingIsRecordedUntilStarted) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(keystroke_trace_count(), 0);
+}
+
+TEST_F(KeystrokeTrace, ReplayedTraceRecordsTheSameTrace) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    std::vector<uint8_t> trace = pack({
+        {5, 0, 0, true},
+        {40, 0, 0, false},
+        {120, 1, 1, true},
+        {250, 1, 6, true},
+        {30, 1, 6, false},
+        {20, 1, 1, false},
+    });
+
+    keystroke_trace_start();
+    replay_trace(trace.data(), trace.size());
+    keystroke_trace_stop();
+
+    std::vector<uint8_t> recorded(trace.size() + KEYSTROKE_TRACE_RECORD_SIZE);
+    recorded.resize(keystroke_trace_read(recorded.data(), recorded.size()));
+    EXPECT_EQ(recorded, trace);
+    EXPECT_EQ(keystroke_trace_count(), 0);
+}
+
+TEST_F(KeystrokeTrace, FullTraceKeepsTheNewestEvents) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    keystroke_trace_start();
+    for (int i = 0; i < KEYSTROKE_TRACE_SIZE / 2 + 1; i++) {
+        press_key(0, 0);
+        run_one_scan_loop();
+        release_key(0, 0);
+        idle_for(i + 1);
+    }
+    EXPECT_EQ(keystroke_trace_count(), KEYSTROKE_TRACE_SIZE);
+
+    // the newest event is the last release, one scan after its press
+    uint8_t record[KEYSTROKE_TRACE_RECORD_SIZE];
+    while (keystroke_trace_count() > 1) {
+        keystroke_trace_read(record, sizeof(record));
+    }
+    keystroke_trace_read(record, sizeof(record));
+    keystroke_trace_event_t event;
+    keystroke_trace_unpack(record, &event);
+    EXPECT_FALSE(event.pressed);
+    EXPECT_EQ(event.delta, 1);
+}
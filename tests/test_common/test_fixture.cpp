@@ -10,6 +10,7 @@ extern "C" {
 #include "debug.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "keystroke_trace.h"
 
 void set_time(uint32_t t);
 void advance_time(uint32_t ms);
@@ -57,3 +58,21 @@ void TestFixture::idle_for(unsigned time) {
         run_one_scan_loop();
     }
 }
+
+void TestFixture::replay_trace(const uint8_t* trace, size_t length) {
+    for (size_t offset = 0; offset + KEYSTROKE_TRACE_RECORD_SIZE <= length; offset += KEYSTROKE_TRACE_RECORD_SIZE) {
+        keystroke_trace_event_t event;
+        keystroke_trace_unpack(trace + offset, &event);
+        idle_for(event.delta);
+        if (event.row >= MATRIX_ROWS || event.col >= MATRIX_COLS) {
+            continue;
+        }
+        if (event.pressed) {
+            press_key(event.col, event.row);
+        } else {
+            release_key(event.col, event.row);
+        }
+    }
+    // let the last event reach action_exec()
+    run_one_scan_loop();
+}
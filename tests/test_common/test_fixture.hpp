@@ -17,6 +17,8 @@
 #pragma once
 
 #include "gtest/gtest.h"
+#include <stddef.h>
+#include <stdint.h>
 
 class TestFixture : public testing::Test {
 public:
@@ -27,4 +29,6 @@ public:
 
     void run_one_scan_loop();
     void idle_for(unsigned ms);
+    // feeds packed keystroke trace records (see quantum/keystroke_trace.h) into the matrix
+    void replay_trace(const uint8_t* trace, size_t length);
 };
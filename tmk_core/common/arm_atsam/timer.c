@@ -12,6 +12,8 @@ uint32_t timer_read32(void) { return (uint32_t)ms_clk; }
 
 uint64_t timer_read64(void) { return ms_clk; }
 
+uint32_t timer_read_us(void) { return (uint32_t)ms_clk * 1000; }
+
 uint16_t timer_elapsed(uint16_t tlast) { return TIMER_DIFF_16(timer_read(), tlast); }
 
 uint32_t timer_elapsed32(uint32_t tlast) { return TIMER_DIFF_32(timer_read32(), tlast); }
@@ -35,6 +35,10 @@
 #    include "rgb_matrix.h"
 #endif
 
+#ifdef EEPROM_DRIVER
+#    include "eeprom_driver.h"
+#endif
+
 /** \brief Suspend idle
  *
  * FIXME: needs doc
@@ -137,6 +141,10 @@ void suspend_power_down(void) {
 
     suspend_power_down_kb();
 
+#ifdef EEPROM_DRIVER
+    eeprom_driver_flush();
+#endif
+
 #ifndef NO_SUSPEND_POWER_DOWN
     // Turn off backlight
 #    ifdef BACKLIGHT_ENABLE
@@ -124,6 +124,37 @@ inline uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(t, last);
 }
 
+#if defined(__AVR_ATmega32A__)
+#    define TIMER_COMPARE_PENDING() (TIFR & _BV(OCF0))
+#elif defined(__AVR_ATtiny85__)
+#    define TIMER_COMPARE_PENDING() (TIFR & _BV(OCF0A))
+#else
+#    define TIMER_COMPARE_PENDING() (TIFR0 & _BV(OCF0A))
+#endif
+
+/** \brief timer read in microseconds
+ *
+ * Combines timer_count with the position of Timer0 within the current millisecond, the resolution
+ * is one Timer0 tick (4us at 16MHz).
+ */
+uint32_t timer_read_us(void) {
+    uint32_t t;
+    uint8_t  raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t   = timer_count;
+        raw = TIMER_RAW;
+        // Timer0 has wrapped but the interrupt hasn't run yet. If raw is still large it was read
+        // just before the wrap.
+        if (TIMER_COMPARE_PENDING() && raw < TIMER_RAW_TOP / 2) {
+            t++;
+        }
+    }
+
+    // raw * 1000 / (TIMER_RAW_TOP + 1), without the division
+    return t * 1000 + (((uint32_t)raw * ((1000UL << 8) / (TIMER_RAW_TOP + 1))) >> 8);
+}
+
 // excecuted once per 1ms.(excess for just timer count?)
 #ifndef __AVR_ATmega32A__
 #    define TIMER_INTERRUPT_VECTOR TIMER0_COMPA_vect
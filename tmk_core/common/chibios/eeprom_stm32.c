@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include "util.h"
 #include "debug.h"
 #include "eeprom_stm32.h"
@@ -53,6 +54,9 @@
  *
  * FEE_PAGE_COUNT   # Total number of pages to use for eeprom simulation (Compact + Write log)
  * FEE_DENSITY_BYTES   # Size of simulated eeprom. (Defaults to half the space allocated by FEE_PAGE_COUNT)
+ * FEE_BACKGROUND_COMPACTION   # Compact from EEPROM_Task() before the write log runs out
+ * FEE_COMPACTION_THRESHOLD   # Free write log bytes left when background compaction starts (Defaults to a quarter of the write log)
+ * FEE_COMPACTION_CHUNK_WORDS   # Words of the compacted area programmed per EEPROM_Task() call (Defaults to 64)
  * NOTE: The current implementation does not include page swapping,
  * and FEE_DENSITY_BYTES will consume that amount of RAM as a cached view of actual EEPROM contents.
  *
@@ -70,7 +74,7 @@
  * Each log entry updates a byte or word in the cache.
  *
  * During reads:
- * EEPROM contents are given back directly from the cache in memory.
+ * EEPROM contents are given back directly from the cache in memory, blocks are copied out in one go.
  *
  * During writes:
  * The contents of the cache is updated first.
@@ -78,12 +82,22 @@
  * Otherwise:
  * If the write log is full, erase both the Compacted-flash area and the Write log, then write cached contents to the Compacted-flash area.
  * Otherwise a Write log entry is constructed and appended to the next free position in the Write log.
+ * Block writes only log the words which changed, and consecutive changed words share a single Word-Run entry.
+ *
+ * With FEE_BACKGROUND_COMPACTION, compaction starts early from EEPROM_Task() once the write log is nearly full.
+ * It erases one page per call, then programs the compacted area a chunk at a time. Until a word has been
+ * programmed again, writes to it only update the cache.
  *
  *
  * *** Write Log Structure ***
  *
  * Write log entries allow for optimized byte writes to addresses below 128. Writing 0 or 1 words are also optimized when word-aligned.
  *
+ * The write log starts with a Layout-Marker. On boot, a missing or different marker means the flash was last
+ * written by other firmware: an unmarked log is replayed and then compacted, an unknown layout is dropped.
+ * Firmware from before the marker reads it as a Word-Next beyond the emulated eeprom, and ignores it,
+ * but it cannot replay Word-Run entries. Clear the eeprom after downgrading to such firmware.
+ *
  * === WRITE LOG ENTRY FORMATS ===
  *
  * ╔═══ Byte-Entry ══╗
@@ -109,9 +123,14 @@
  * ╚════════════════╝
  * 0 <= Address <= 0x3FFE (16382)
  *
- * ╔═══ Reserved ═══╗
- * ║110XXXXXXXXXXXXX║
- * ╚════════════════╝
+ * ╔═════════════════════ Word-Run ══════════════════════╗
+ * ║110XXXXXXXXXXXXX║NNNNNNNNNNNNNNNN║YYYYYYYYYYYYYYYY║...
+ * ║  │└─────┬─────┘║└───────┬──────┘║└───────┬──────┘║
+ * ║  │Address >> 1 ║   Word count   ║  ~Value[0..N)  ║
+ * ║  └── Run       ║                ║                ║
+ * ╚════════════════╩════════════════╩════════════════╝
+ * 0x80 <= Address <= 0x3FFE (16382)
+ * Values are never 0, an unprogrammed value word is an incomplete write.
  *
  * ╔═══════════ Word-Next ═══════════╗
  * ║111XXXXXXXXXXXXX║YYYYYYYYYYYYYYYY║
@@ -121,13 +140,21 @@
  * (  0 <= Address <  0x0080 (128): Reserved)
  * 0x80 <= Address <= 0x3FFE (16382)
  *
+ * ╔═════════ Layout-Marker ═════════╗
+ * ║1111111111000000║VVVVVVVVVVVVVVVV║
+ * ║                ║└───────┬──────┘║
+ * ║                ║    ~Version    ║
+ * ╚════════════════╩════════════════╝
+ * Only valid as the first entry of the write log.
+ *
  * Write Log entry ranges:
  * 0x0000 ... 0x7FFF - Byte-Entry;     address is (Entry & 0x7F00) >> 4; value is (Entry & 0xFF)
  * 0x8000 ... 0x9FFF - Word-Encoded 0; address is (Entry & 0x1FFF) << 1; value is 0
  * 0xA000 ... 0xBFFF - Word-Encoded 1; address is (Entry & 0x1FFF) << 1; value is 1
- * 0xC000 ... 0xDFFF - Reserved
+ * 0xC000 ... 0xDFFF - Word-Run;       address is (Entry & 0x1FFF) << 1; count is Next_Entry; values are ~(Following_Entries)
  * 0xE000 ... 0xFFBF - Word-Next;      address is (Entry & 0x1FFF) << 1 + 0x80; value is ~(Next_Entry)
- * 0xFFC0 ... 0xFFFE - Reserved
+ * 0xFFC0            - Layout-Marker;  version is ~(Next_Entry)
+ * 0xFFC1 ... 0xFFFE - Reserved
  * 0xFFFF            - Unprogrammed
  *
  */
@@ -140,10 +167,17 @@
 /* These bits are used for optimizing encoding of bytes, 0 and 1 */
 #define FEE_WORD_ENCODING 0x8000
 #define FEE_VALUE_NEXT 0x6000
-#define FEE_VALUE_RESERVED 0x4000
+#define FEE_VALUE_RUN 0x4000
 #define FEE_VALUE_ENCODED 0x2000
 #define FEE_BYTE_RANGE 0x80
 
+/* Shorter runs of changed words are cheaper as individual Word-Next entries */
+#define FEE_RUN_MIN_WORDS 3
+
+/* First write log entry, followed by the layout version.  Bump the version when the log encoding changes */
+#define FEE_LAYOUT_MARKER 0xFFC0
+#define FEE_LAYOUT_VERSION 1
+
 /* Addressable range 16KByte: 0 <-> (0x1FFF << 1) */
 #define FEE_ADDRESS_MAX_SIZE 0x4000
 
@@ -204,11 +238,24 @@
 #define FEE_WRITE_LOG_BASE_ADDRESS FEE_COMPACTED_LAST_ADDRESS
 /* End of the emulated eeprom write log */
 #define FEE_WRITE_LOG_LAST_ADDRESS (FEE_WRITE_LOG_BASE_ADDRESS + FEE_WRITE_LOG_BYTES)
+/* Size of the layout marker, a write log without room for one can't hold entries from other firmware either */
+#define FEE_LAYOUT_MARKER_BYTES (FEE_WRITE_LOG_BYTES >= 4 ? 4 : 0)
+/* Start of the emulated eeprom write log entries */
+#define FEE_WRITE_LOG_START_ADDRESS (FEE_WRITE_LOG_BASE_ADDRESS + FEE_LAYOUT_MARKER_BYTES)
 
 #if defined(DYNAMIC_KEYMAP_EEPROM_MAX_ADDR) && (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR >= FEE_DENSITY_BYTES)
 #    error emulated eeprom: DYNAMIC_KEYMAP_EEPROM_MAX_ADDR is greater than the FEE_DENSITY_BYTES available
 #endif
 
+#ifdef FEE_BACKGROUND_COMPACTION
+#    ifndef FEE_COMPACTION_THRESHOLD
+#        define FEE_COMPACTION_THRESHOLD (FEE_WRITE_LOG_BYTES / 4)
+#    endif
+#    ifndef FEE_COMPACTION_CHUNK_WORDS
+#        define FEE_COMPACTION_CHUNK_WORDS 64
+#    endif
+#endif
+
 /* In-memory contents of emulated eeprom for faster access */
 /* *TODO: Implement page swapping */
 static uint16_t WordBuf[FEE_DENSITY_BYTES / 2];
@@ -217,6 +264,18 @@ static uint8_t *DataBuf = (uint8_t *)WordBuf;
 /* Pointer to the first available slot within the write log */
 static uint16_t *empty_slot;
 
+#ifdef FEE_BACKGROUND_COMPACTION
+/* Background compaction progress: pages are erased first, then the compacted area is programmed up to compaction_dest */
+static bool      compacting;
+static uint16_t  compaction_page;
+static uintptr_t compaction_dest;
+
+/* Whether a word is still to be programmed by the background compaction, which will pick it up from DataBuf */
+static inline bool eeprom_compaction_pending(uint16_t Address) { return compacting && FEE_COMPACTED_BASE_ADDRESS + (Address & 0xFFFE) >= compaction_dest; }
+#else
+#    define eeprom_compaction_pending(Address) false
+#endif
+
 // #define DEBUG_EEPROM_OUTPUT
 
 /*
@@ -275,7 +334,38 @@ void print_eeprom(void) {
 #endif
 }
 
+static uint8_t eeprom_compact(void);
+
+/* Layout of the write log, 0 if it was written by firmware from before the layout marker */
+static uint16_t eeprom_layout_version(void) {
+    if (!FEE_LAYOUT_MARKER_BYTES) return FEE_LAYOUT_VERSION;
+
+    uint16_t *marker = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS;
+    if (marker[0] != FEE_LAYOUT_MARKER) return 0;
+    return ~marker[1];
+}
+
+/* Start an empty write log, flash must be unlocked */
+static FLASH_Status eeprom_write_layout_marker(void) {
+    FLASH_Status final_status = FLASH_COMPLETE;
+
+    empty_slot = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS;
+    if (FEE_LAYOUT_MARKER_BYTES) {
+        eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, FEE_LAYOUT_MARKER);
+        final_status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, FEE_LAYOUT_MARKER);
+        eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, (uint16_t)~FEE_LAYOUT_VERSION);
+        FLASH_Status status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, (uint16_t)~FEE_LAYOUT_VERSION);
+        if (status != FLASH_COMPLETE) final_status = status;
+    }
+    return final_status;
+}
+
 uint16_t EEPROM_Init(void) {
+#ifdef FEE_BACKGROUND_COMPACTION
+    /* Flash isn't consistent until the compaction has finished */
+    if (compacting) eeprom_compact();
+#endif
+
     /* Load emulated eeprom contents from compacted flash into memory */
     uint16_t *src  = (uint16_t *)FEE_COMPACTED_BASE_ADDRESS;
     uint16_t *dest = (uint16_t *)DataBuf;
@@ -289,9 +379,18 @@ uint16_t EEPROM_Init(void) {
         println("EEPROM_Init Write Log:");
     }
 
-    /* Replay write log */
+    /* Replay write log, older firmware only used a subset of the current encoding */
+    uint16_t  layout = eeprom_layout_version();
     uint16_t *log_addr;
-    for (log_addr = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS; log_addr < (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS; ++log_addr) {
+    if (layout == FEE_LAYOUT_VERSION) {
+        log_addr = (uint16_t *)FEE_WRITE_LOG_START_ADDRESS;
+    } else if (!layout) {
+        log_addr = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS;
+    } else {
+        eeprom_printf("Unknown layout version: %d;\n", layout);
+        log_addr = (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS;
+    }
+    for (; log_addr < (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS; ++log_addr) {
         uint16_t address = *log_addr;
         if (address == FEE_EMPTY_WORD) {
             break;
@@ -320,12 +419,34 @@ uint16_t EEPROM_Init(void) {
                 address <<= 1;
                 /* Writes to addresses less than 128 are byte log entries */
                 address += FEE_BYTE_RANGE;
-            } else {
-                /* Reserved for future use */
-                if (address & FEE_VALUE_RESERVED) {
-                    eeprom_printf("Reserved encoded value at log_addr: 0x%04x;\n", (uint32_t)log_addr);
+            } else if (address & FEE_VALUE_RUN) {
+                /* Read the word count from next word */
+                if (++log_addr >= (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS) {
+                    break;
+                }
+                uint16_t count = *log_addr;
+                if (count == FEE_EMPTY_WORD) {
+                    eeprom_printf("Incomplete write at log_addr: 0x%04x;\n", (uint32_t)log_addr);
+                    /* Possibly incomplete write.  Ignore and continue */
                     continue;
                 }
+                /* Read values from the following words */
+                uint32_t  run_address = (address & 0x1FFF) << 1;
+                uint16_t *run_last    = log_addr + count;
+                if (run_last >= (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS) {
+                    run_last = (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS - 1;
+                }
+                while (log_addr < run_last) {
+                    wvalue = ~*++log_addr;
+                    /* Possibly incomplete write, values in a run are never 0 */
+                    if (wvalue && run_address < FEE_DENSITY_BYTES) {
+                        eeprom_printf("DataBuf[0x%04x] = 0x%04x;\n", run_address, wvalue);
+                        *(uint16_t *)(&DataBuf[run_address]) = wvalue;
+                    }
+                    run_address += 2;
+                }
+                continue;
+            } else {
                 /* Optimization for 0 or 1 values. */
                 wvalue = (address & FEE_VALUE_ENCODED) >> 13;
                 address &= 0x1FFF;
@@ -342,6 +463,18 @@ uint16_t EEPROM_Init(void) {
 
     empty_slot = log_addr;
 
+    /* Bring flash written by other firmware up to the current layout */
+    if (layout != FEE_LAYOUT_VERSION) {
+        if (!layout && empty_slot == (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS && ((uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS)[1] == FEE_EMPTY_WORD) {
+            /* Nothing logged yet, the marker fits in front */
+            FLASH_Unlock();
+            eeprom_write_layout_marker();
+            FLASH_Lock();
+        } else {
+            eeprom_compact();
+        }
+    }
+
     if (debug_eeprom) {
         println("EEPROM_Init Final DataBuf:");
         print_eeprom();
@@ -359,10 +492,15 @@ static void eeprom_clear(void) {
         FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE));
     }
 
+    eeprom_write_layout_marker();
+
     FLASH_Lock();
 
-    empty_slot = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS;
     eeprom_printf("eeprom_clear empty_slot: 0x%08x\n", (uint32_t)empty_slot);
+
+#ifdef FEE_BACKGROUND_COMPACTION
+    compacting = false;
+#endif
 }
 
 /* Erase emulated eeprom */
@@ -498,6 +636,71 @@ static uint8_t eeprom_write_log_byte_entry(uint16_t Address) {
     return status;
 }
 
+static uint8_t eeprom_write_log_run_entry(uint16_t Address, uint16_t Count) {
+    eeprom_printf("eeprom_write_log_run_entry(0x%04x, %d)\n", Address, Count);
+
+    FLASH_Status final_status = FLASH_COMPLETE;
+
+    if (Count < FEE_RUN_MIN_WORDS) {
+        for (; Count; --Count, Address += 2) {
+            FLASH_Status status = eeprom_write_log_word_entry(Address);
+            if (status != FLASH_COMPLETE) final_status = status;
+        }
+        return final_status;
+    }
+
+    /* if we can't find an empty spot, we must compact emulated eeprom */
+    if (empty_slot > (uint16_t *)(FEE_WRITE_LOG_LAST_ADDRESS - (Count + 2) * 2)) {
+        /* compact the write log into the compacted flash area */
+        return eeprom_compact();
+    }
+
+    FLASH_Unlock();
+
+    /* address and word count, followed by the values */
+    uint16_t entry = FEE_WORD_ENCODING | FEE_VALUE_RUN | (Address >> 1);
+    eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, entry);
+    final_status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, entry);
+    eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, Count);
+    FLASH_Status status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, Count);
+    if (status != FLASH_COMPLETE) final_status = status;
+
+    uint16_t *src = (uint16_t *)(&DataBuf[Address]);
+    for (; Count; --Count, ++src) {
+        eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, ~*src);
+        status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, ~*src);
+        if (status != FLASH_COMPLETE) final_status = status;
+    }
+
+    FLASH_Lock();
+
+    return final_status;
+}
+
+/* Append a word which changed from OldValue to the write log */
+static uint8_t eeprom_write_log_entry(uint16_t Address, uint16_t OldValue) {
+    uint16_t value = *(uint16_t *)(&DataBuf[Address]);
+
+    /* Check if we need to fall back to byte write */
+    if (Address < FEE_BYTE_RANGE) {
+        FLASH_Status final_status = FLASH_COMPLETE;
+        /* Only write a byte if it has changed */
+        if ((uint8_t)OldValue != (uint8_t)value) {
+            final_status = eeprom_write_log_byte_entry(Address);
+            /* Nothing left to log if that compacted the write log */
+            if (empty_slot == (uint16_t *)FEE_WRITE_LOG_START_ADDRESS) return final_status;
+        }
+        FLASH_Status status = FLASH_COMPLETE;
+        /* Only write a byte if it has changed */
+        if ((OldValue >> 8) != (value >> 8)) {
+            status = eeprom_write_log_byte_entry(Address + 1);
+        }
+        if (status != FLASH_COMPLETE) final_status = status;
+        return final_status;
+    }
+    return eeprom_write_log_word_entry(Address);
+}
+
 uint8_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
     /* if the address is out-of-bounds, do nothing */
     if (Address >= FEE_DENSITY_BYTES) {
@@ -515,6 +718,9 @@ uint8_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
     DataBuf[Address] = DataByte;
     eeprom_printf("EEPROM_WriteDataByte DataBuf[0x%04x] = 0x%02x\n", Address, DataBuf[Address]);
 
+    /* the background compaction will get to it */
+    if (eeprom_compaction_pending(Address)) return FLASH_COMPLETE;
+
     /* perform the write into flash memory */
     /* First, attempt to write directly into the compacted flash area */
     FLASH_Status status = eeprom_write_direct_entry(Address);
@@ -562,27 +768,15 @@ uint8_t EEPROM_WriteDataWord(uint16_t Address, uint16_t DataWord) {
     *(uint16_t *)(&DataBuf[Address]) = DataWord;
     eeprom_printf("EEPROM_WriteDataWord DataBuf[0x%04x] = 0x%04x\n", Address, *(uint16_t *)(&DataBuf[Address]));
 
+    /* the background compaction will get to it */
+    if (eeprom_compaction_pending(Address)) return FLASH_COMPLETE;
+
     /* perform the write into flash memory */
     /* First, attempt to write directly into the compacted flash area */
     final_status = eeprom_write_direct_entry(Address);
     if (!final_status) {
         /* Otherwise append to the write log */
-        /* Check if we need to fall back to byte write */
-        if (Address < FEE_BYTE_RANGE) {
-            final_status = FLASH_COMPLETE;
-            /* Only write a byte if it has changed */
-            if ((uint8_t)oldValue != (uint8_t)DataWord) {
-                final_status = eeprom_write_log_byte_entry(Address);
-            }
-            FLASH_Status status = FLASH_COMPLETE;
-            /* Only write a byte if it has changed */
-            if ((oldValue >> 8) != (DataWord >> 8)) {
-                status = eeprom_write_log_byte_entry(Address + 1);
-            }
-            if (status != FLASH_COMPLETE) final_status = status;
-        } else {
-            final_status = eeprom_write_log_word_entry(Address);
-        }
+        final_status = eeprom_write_log_entry(Address, oldValue);
     }
     if (final_status != 0 && final_status != FLASH_COMPLETE) {
         eeprom_printf("EEPROM_WriteDataWord [STATUS == %d]\n", final_status);
@@ -619,6 +813,62 @@ uint16_t EEPROM_ReadDataWord(uint16_t Address) {
     return DataWord;
 }
 
+void EEPROM_Task(void) {
+#ifdef FEE_BACKGROUND_COMPACTION
+    if (!compacting) {
+        /* Wait until the write log is nearly full */
+        if ((uintptr_t)empty_slot + FEE_COMPACTION_THRESHOLD < FEE_WRITE_LOG_LAST_ADDRESS) return;
+
+        eeprom_println("EEPROM_Task compaction start");
+        compacting      = true;
+        compaction_page = 0;
+        compaction_dest = FEE_COMPACTED_BASE_ADDRESS;
+    }
+
+    FLASH_Unlock();
+
+    if (compaction_page < FEE_PAGE_COUNT) {
+        /* One page erase per call */
+        eeprom_printf("FLASH_ErasePage(0x%04x)\n", (uint32_t)(FEE_PAGE_BASE_ADDRESS + (compaction_page * FEE_PAGE_SIZE)));
+        FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (compaction_page * FEE_PAGE_SIZE));
+        if (++compaction_page == FEE_PAGE_COUNT) {
+            eeprom_write_layout_marker();
+        }
+    } else {
+        /* Then a chunk of the compacted area */
+        uint16_t *src  = (uint16_t *)(&DataBuf[compaction_dest - FEE_COMPACTED_BASE_ADDRESS]);
+        uintptr_t last = compaction_dest + FEE_COMPACTION_CHUNK_WORDS * 2;
+        if (last > FEE_COMPACTED_LAST_ADDRESS) last = FEE_COMPACTED_LAST_ADDRESS;
+        for (; compaction_dest < last; ++src, compaction_dest += 2) {
+            if (*src) {
+                eeprom_printf("FLASH_ProgramHalfWord(0x%04x, 0x%04x)\n", (uint32_t)compaction_dest, ~*src);
+                FLASH_ProgramHalfWord(compaction_dest, ~*src);
+            }
+        }
+        if (compaction_dest == FEE_COMPACTED_LAST_ADDRESS) {
+            eeprom_println("EEPROM_Task compaction done");
+            compacting = false;
+        }
+    }
+
+    FLASH_Lock();
+#endif
+}
+
+void EEPROM_Flush(void) {
+#ifdef FEE_BACKGROUND_COMPACTION
+    if (compacting) eeprom_compact();
+#endif
+}
+
+bool EEPROM_Compacting(void) {
+#ifdef FEE_BACKGROUND_COMPACTION
+    return compacting;
+#else
+    return false;
+#endif
+}
+
 /*****************************************************************************
  *  Wrap library in AVR style functions.
  *******************************************************************************/
@@ -664,63 +914,76 @@ void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
 void eeprom_update_dword(uint32_t *Address, uint32_t Value) { eeprom_write_dword(Address, Value); }
 
 void eeprom_read_block(void *buf, const void *addr, size_t len) {
-    const uint8_t *src  = (const uint8_t *)addr;
-    uint8_t *      dest = (uint8_t *)buf;
+    uintptr_t offset = (uintptr_t)addr;
+    uint8_t * dest   = (uint8_t *)buf;
 
-    /* Check word alignment */
-    if (len && (uintptr_t)src % 2) {
-        /* Read the unaligned first byte */
-        *dest++ = eeprom_read_byte(src++);
-        --len;
-    }
-
-    uint16_t value;
-    bool     aligned = ((uintptr_t)dest % 2 == 0);
-    while (len > 1) {
-        value = eeprom_read_word((uint16_t *)src);
-        if (aligned) {
-            *(uint16_t *)dest = value;
-            dest += 2;
-        } else {
-            *dest++ = value;
-            *dest++ = value >> 8;
-        }
-        src += 2;
-        len -= 2;
-    }
-    if (len) {
-        *dest = eeprom_read_byte(src);
+    /* Copy straight out of the in-memory contents */
+    if (offset < FEE_DENSITY_BYTES) {
+        size_t count = FEE_DENSITY_BYTES - offset;
+        if (count > len) count = len;
+        memcpy(dest, &DataBuf[offset], count);
+        dest += count;
+        len -= count;
     }
+
+    /* Out-of-bounds reads give back 0xFF */
+    memset(dest, 0xFF, len);
 }
 
 void eeprom_write_block(const void *buf, void *addr, size_t len) {
-    uint8_t *      dest = (uint8_t *)addr;
-    const uint8_t *src  = (const uint8_t *)buf;
-
-    /* Check word alignment */
-    if (len && (uintptr_t)dest % 2) {
-        /* Write the unaligned first byte */
-        eeprom_write_byte(dest++, *src++);
-        --len;
-    }
+    uintptr_t      offset = (uintptr_t)addr;
+    const uint8_t *src    = (const uint8_t *)buf;
 
-    uint16_t value;
-    bool     aligned = ((uintptr_t)src % 2 == 0);
-    while (len > 1) {
-        if (aligned) {
-            value = *(uint16_t *)src;
+    /* if the address is out-of-bounds, do nothing */
+    if (offset >= FEE_DENSITY_BYTES) return;
+    if (len > FEE_DENSITY_BYTES - offset) len = FEE_DENSITY_BYTES - offset;
+
+    uint16_t end       = offset + len;
+    uint16_t run_start = 0;
+    uint16_t run_count = 0;
+    for (uint16_t address = offset & 0xFFFE; address < end; address += 2) {
+        uint16_t oldValue = *(uint16_t *)(&DataBuf[address]);
+        uint16_t value    = oldValue;
+        if (address >= offset && address + 2 <= end) {
+            memcpy(&value, &src[address - offset], 2);
         } else {
-            value = *(uint8_t *)src | (*(uint8_t *)(src + 1) << 8);
+            /* Partial word at either end of the block */
+            uint8_t *bytes = (uint8_t *)&value;
+            if (address >= offset) bytes[0] = src[address - offset];
+            if (address + 1 < end) bytes[1] = src[address + 1 - offset];
         }
-        eeprom_write_word((uint16_t *)dest, value);
-        dest += 2;
-        src += 2;
-        len -= 2;
-    }
 
-    if (len) {
-        eeprom_write_byte(dest, *src);
+        /* if the value is the same, don't bother writing it */
+        if (value == oldValue) {
+            if (run_count) eeprom_write_log_run_entry(run_start, run_count);
+            run_count = 0;
+            continue;
+        }
+
+        /* Nonzero words which need a log entry can join a run */
+        if (value && address >= FEE_BYTE_RANGE && !eeprom_compaction_pending(address) && *(uint16_t *)(FEE_COMPACTED_BASE_ADDRESS + address) != FEE_EMPTY_WORD) {
+            if (!run_count) run_start = address;
+            ++run_count;
+            *(uint16_t *)(&DataBuf[address]) = value;
+            continue;
+        }
+
+        if (run_count) eeprom_write_log_run_entry(run_start, run_count);
+        run_count = 0;
+
+        /* keep DataBuf cache in sync */
+        *(uint16_t *)(&DataBuf[address]) = value;
+
+        /* the background compaction will get to it */
+        if (eeprom_compaction_pending(address)) continue;
+
+        /* First, attempt to write directly into the compacted flash area */
+        if (!eeprom_write_direct_entry(address)) {
+            /* Otherwise append to the write log */
+            eeprom_write_log_entry(address, oldValue);
+        }
     }
+    if (run_count) eeprom_write_log_run_entry(run_start, run_count);
 }
 
 void eeprom_update_block(const void *buf, void *addr, size_t len) { eeprom_write_block(buf, addr, len); }
@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 uint16_t EEPROM_Init(void);
 void     EEPROM_Erase(void);
 uint8_t  EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte);
@@ -30,4 +33,14 @@ uint8_t  EEPROM_WriteDataWord(uint16_t Address, uint16_t DataWord);
 uint8_t  EEPROM_ReadDataByte(uint16_t Address);
 uint16_t EEPROM_ReadDataWord(uint16_t Address);
 
+/* Background compaction, see FEE_BACKGROUND_COMPACTION */
+void EEPROM_Task(void);
+void EEPROM_Flush(void);
+bool EEPROM_Compacting(void);
+
+/* Milliseconds without input before the main loop lets EEPROM_Task() start a compaction */
+#ifndef FEE_COMPACTION_IDLE_TIME
+#    define FEE_COMPACTION_IDLE_TIME 500
+#endif
+
 void print_eeprom(void);
@@ -31,6 +31,14 @@
 #    include "rgb_matrix.h"
 #endif
 
+#ifdef EEPROM_DRIVER
+#    include "eeprom_driver.h"
+#endif
+
+#ifdef STM32_EEPROM_ENABLE
+#    include "eeprom_stm32.h"
+#endif
+
 /** \brief suspend idle
  *
  * FIXME: needs doc
@@ -56,6 +64,13 @@ __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+#ifdef EEPROM_DRIVER
+    eeprom_driver_flush();
+#endif
+#ifdef STM32_EEPROM_ENABLE
+    EEPROM_Flush();
+#endif
+
 #ifdef BACKLIGHT_ENABLE
     backlight_set(0);
 #endif
@@ -23,6 +23,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "debug.h"
 #include "digitizer.h"
+#include "scan_profiler.h"
+#include "latency_probe.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -69,7 +71,10 @@ void host_keyboard_send(report_keyboard_t *report) {
         report->report_id = REPORT_ID_KEYBOARD;
 #endif
     }
+    SCAN_PROFILE_BEGIN(SCAN_PHASE_HOST_SEND);
+    latency_probe_report();
     (*driver->send_keyboard)(report);
+    SCAN_PROFILE_END(SCAN_PHASE_HOST_SEND);
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -88,6 +93,21 @@ void host_mouse_send(report_mouse_t *report) {
     (*driver->send_mouse)(report);
 }
 
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+report_mouse_feature_t mouse_feature_report = {
+#    ifdef MOUSE_SHARED_EP
+    .report_id = REPORT_ID_MOUSE,
+#    endif
+};
+#endif
+
+uint8_t host_mouse_scroll_multiplier(void) {
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+    if (mouse_feature_report.resolution_multiplier) return MOUSE_SCROLL_MULTIPLIER;
+#endif
+    return 1;
+}
+
 void host_system_send(uint16_t report) {
     if (report == last_system_report) return;
     last_system_report = report;
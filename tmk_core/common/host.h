@@ -35,6 +35,9 @@ extern "C" {
 
 extern uint8_t keyboard_idle;
 extern uint8_t keyboard_protocol;
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+extern report_mouse_feature_t mouse_feature_report;
+#endif
 
 /* host driver */
 void           host_set_driver(host_driver_t *driver);
@@ -48,6 +51,9 @@ void    host_mouse_send(report_mouse_t *report);
 void    host_system_send(uint16_t data);
 void    host_consumer_send(uint16_t data);
 
+/* Wheel units per notch the host expects, 1 unless it has enabled high-resolution scrolling */
+uint8_t host_mouse_scroll_multiplier(void);
+
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
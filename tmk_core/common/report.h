@@ -195,17 +195,49 @@ typedef struct {
     uint16_t usage;
 } __attribute__((packed)) report_extra_t;
 
+/* Movement is reported in 16 bits with MOUSE_EXTENDED_REPORT, so that fast sensors aren't clipped
+ * to 127 counts per report. With MOUSE_SCROLL_HIRES_ENABLE the wheels are reported in 16 bits as
+ * well, in 1/MOUSE_SCROLL_MULTIPLIER of a notch once the host has enabled the resolution
+ * multiplier, see host_mouse_scroll_multiplier().
+ */
+#ifdef MOUSE_EXTENDED_REPORT
+typedef int16_t mouse_xy_report_t;
+#    define MOUSE_REPORT_XY_MAX 32767
+#else
+typedef int8_t mouse_xy_report_t;
+#    define MOUSE_REPORT_XY_MAX 127
+#endif
+
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+typedef int16_t mouse_hv_report_t;
+#    define MOUSE_REPORT_HV_MAX 32767
+#    ifndef MOUSE_SCROLL_MULTIPLIER
+#        define MOUSE_SCROLL_MULTIPLIER 120
+#    endif
+#else
+typedef int8_t mouse_hv_report_t;
+#    define MOUSE_REPORT_HV_MAX 127
+#endif
+
 typedef struct {
 #ifdef MOUSE_SHARED_EP
     uint8_t report_id;
 #endif
-    uint8_t buttons;
-    int8_t  x;
-    int8_t  y;
-    int8_t  v;
-    int8_t  h;
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    mouse_hv_report_t v;
+    mouse_hv_report_t h;
 } __attribute__((packed)) report_mouse_t;
 
+/* Feature report of the mouse, set by the host */
+typedef struct {
+#ifdef MOUSE_SHARED_EP
+    uint8_t report_id;
+#endif
+    uint8_t resolution_multiplier;
+} __attribute__((packed)) report_mouse_feature_t;
+
 typedef struct {
 #ifdef DIGITIZER_SHARED_EP
     uint8_t report_id;
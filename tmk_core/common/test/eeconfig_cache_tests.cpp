@@ -0,0 +1,156 @@
+/* Copyright 2021
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "eeprom.h"
+#include "eeconfig.h"
+#include "action_layer.h"
+
+layer_state_t default_layer_state;
+
+/* Migration hook under test */
+static int      migrate_calls;
+static uint16_t migrate_magic;
+static bool     migrate_result;
+
+bool eeconfig_migrate_user(uint16_t magic) {
+    migrate_calls++;
+    migrate_magic = magic;
+    if (migrate_result) {
+        eeconfig_update_user(eeconfig_read_user() & 0xFF);
+    }
+    return migrate_result;
+}
+}
+
+#define OLD_MAGIC_NUMBER (uint16_t)0xFEEA
+
+class EeconfigCacheTest : public testing::Test {
+   public:
+    EeconfigCacheTest() {}
+    ~EeconfigCacheTest() {}
+
+   protected:
+    void SetUp() override {
+        /* Start from a blank EEPROM */
+        uint8_t blank[EECONFIG_SIZE] = {0};
+        eeprom_update_block(blank, EECONFIG_MAGIC, sizeof(blank));
+        eeconfig_reload();
+        migrate_calls  = 0;
+        migrate_magic  = 0xFFFF;
+        migrate_result = false;
+    }
+};
+
+TEST_F(EeconfigCacheTest, TestBlankIsInvalid) {
+    eeconfig_reload();
+    EXPECT_FALSE(eeconfig_is_enabled());
+    EXPECT_FALSE(eeconfig_is_disabled());
+    EXPECT_EQ(migrate_calls, 1);
+    EXPECT_EQ(migrate_magic, 0);
+}
+
+TEST_F(EeconfigCacheTest, TestLoad) {
+    eeconfig_init();
+    eeconfig_update_user(0x12345678);
+    eeconfig_update_debug(0x3c);
+    eeconfig_commit();
+    /* The magic word is sealed with the checksum */
+    EXPECT_NE(eeprom_read_word(EECONFIG_MAGIC), EECONFIG_MAGIC_NUMBER);
+    /* Values come back from the EEPROM */
+    migrate_calls = 0;
+    eeconfig_reload();
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678);
+    EXPECT_EQ(eeconfig_read_debug(), 0x3c);
+    EXPECT_EQ(migrate_calls, 0);
+}
+
+TEST_F(EeconfigCacheTest, TestUpdateIsDeferred) {
+    eeconfig_init();
+    eeconfig_update_user(0x12345678);
+    /* Updates stay in RAM until committed */
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678);
+    EXPECT_EQ(eeprom_read_dword(EECONFIG_USER), 0);
+    uint16_t magic = eeprom_read_word(EECONFIG_MAGIC);
+    eeconfig_commit();
+    EXPECT_EQ(eeprom_read_dword(EECONFIG_USER), 0x12345678);
+    EXPECT_NE(eeprom_read_word(EECONFIG_MAGIC), magic);
+    /* Uncommitted updates are dropped on reload */
+    eeconfig_update_user(0x9abcdef0);
+    eeconfig_reload();
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678);
+}
+
+TEST_F(EeconfigCacheTest, TestChecksumMismatch) {
+    eeconfig_init();
+    eeconfig_update_user(0x12345678);
+    eeconfig_commit();
+    uint16_t magic = eeprom_read_word(EECONFIG_MAGIC);
+    /* Written behind the cache's back, or torn */
+    eeprom_update_byte((uint8_t *)EECONFIG_USER, 0x00);
+    migrate_calls = 0;
+    eeconfig_reload();
+    EXPECT_FALSE(eeconfig_is_enabled());
+    /* The migration hook sees the stored magic word, and declines */
+    EXPECT_EQ(migrate_calls, 1);
+    EXPECT_EQ(migrate_magic, magic);
+}
+
+TEST_F(EeconfigCacheTest, TestLegacyRecord) {
+    /* Written by firmware without the cache */
+    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeprom_update_dword(EECONFIG_USER, 0x12345678);
+    eeconfig_reload();
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678);
+    EXPECT_EQ(migrate_calls, 0);
+    /* Sealed on the next commit */
+    eeconfig_commit();
+    EXPECT_NE(eeprom_read_word(EECONFIG_MAGIC), EECONFIG_MAGIC_NUMBER);
+    eeconfig_reload();
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678);
+}
+
+TEST_F(EeconfigCacheTest, TestMigrate) {
+    /* Written by firmware with an older layout */
+    eeprom_update_word(EECONFIG_MAGIC, OLD_MAGIC_NUMBER);
+    eeprom_update_dword(EECONFIG_USER, 0x12345678);
+    migrate_result = true;
+    eeconfig_reload();
+    EXPECT_EQ(migrate_calls, 1);
+    EXPECT_EQ(migrate_magic, OLD_MAGIC_NUMBER);
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeconfig_read_user(), 0x78);
+    /* The converted record is kept */
+    eeconfig_commit();
+    eeconfig_reload();
+    EXPECT_EQ(migrate_calls, 1);
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(eeconfig_read_user(), 0x78);
+}
+
+TEST_F(EeconfigCacheTest, TestDisable) {
+    eeconfig_init();
+    eeconfig_disable();
+    EXPECT_EQ(eeprom_read_word(EECONFIG_MAGIC), EECONFIG_MAGIC_NUMBER_OFF);
+    eeconfig_reload();
+    EXPECT_FALSE(eeconfig_is_enabled());
+    EXPECT_TRUE(eeconfig_is_disabled());
+}
@@ -49,6 +49,8 @@ extern "C" {
 #define EEPROM_SIZE (FEE_PAGE_SIZE * FEE_PAGE_COUNT / 2)
 #define LOG_SIZE EEPROM_SIZE
 #define LOG_BASE (MOCK_FLASH_SIZE - LOG_SIZE)
+/* First entry after the layout marker */
+#define LOG_START (LOG_BASE + 4)
 #define EEPROM_BASE (LOG_BASE - EEPROM_SIZE)
 
 /* Log encoding helpers */
@@ -56,6 +58,9 @@ extern "C" {
 #define WORD_ZERO(addr) (0x8000 | ((addr) >> 1))
 #define WORD_ONE(addr) (0xA000 | ((addr) >> 1))
 #define WORD_NEXT(addr) (0xE000 | (((addr)-0x80) >> 1))
+#define WORD_RUN(addr) (0xC000 | ((addr) >> 1))
+#define LAYOUT_MARKER 0xFFC0
+#define LAYOUT_VERSION 1
 
 class EepromStm32Test : public testing::Test {
    public:
@@ -118,11 +123,11 @@ TEST_F(EepromStm32Test, TestReadByte) {
     EXPECT_EQ(EEPROM_ReadDataByte(EEPROM_SIZE - 2), 0x78);
     EXPECT_EQ(EEPROM_ReadDataByte(EEPROM_SIZE - 1), 0x56);
     /* Write Log byte value */
-    FlashBuf[LOG_BASE]     = 0x65;
-    FlashBuf[LOG_BASE + 1] = 3;
+    FlashBuf[LOG_START]     = 0x65;
+    FlashBuf[LOG_START + 1] = 3;
     /* Write Log word value */
-    *(uint16_t*)&FlashBuf[LOG_BASE + 2] = WORD_NEXT(EEPROM_SIZE - 2);
-    *(uint16_t*)&FlashBuf[LOG_BASE + 4] = ~0x9abc;
+    *(uint16_t*)&FlashBuf[LOG_START + 2] = WORD_NEXT(EEPROM_SIZE - 2);
+    *(uint16_t*)&FlashBuf[LOG_START + 4] = ~0x9abc;
     /* Check values */
     EEPROM_Init();
     EXPECT_EQ(EEPROM_ReadDataByte(2), 0xef);
@@ -144,9 +149,9 @@ TEST_F(EepromStm32Test, TestWriteByte) {
     EXPECT_EQ(FlashBuf[EEPROM_BASE + EEPROM_SIZE - 2], (uint8_t)~0x78);
 
     /* Second write per aligned word requires a log entry */
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], BYTE_VALUE(3, 0xbe));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], WORD_NEXT(EEPROM_SIZE - 1));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 4], (uint16_t)~0x5678);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], BYTE_VALUE(3, 0xbe));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 2], WORD_NEXT(EEPROM_SIZE - 1));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 4], (uint16_t)~0x5678);
 }
 
 TEST_F(EepromStm32Test, TestByteRoundTrip) {
@@ -194,12 +199,12 @@ TEST_F(EepromStm32Test, TestReadWord) {
     EXPECT_EQ(EEPROM_ReadDataWord(EEPROM_SIZE - 4), 0x1234);
     EXPECT_EQ(EEPROM_ReadDataWord(EEPROM_SIZE - 2), 0x5678);
     /* Write Log word zero-encoded */
-    *(uint16_t*)&FlashBuf[LOG_BASE] = WORD_ZERO(200);
+    *(uint16_t*)&FlashBuf[LOG_START] = WORD_ZERO(200);
     /* Write Log word one-encoded */
-    *(uint16_t*)&FlashBuf[LOG_BASE + 2] = WORD_ONE(EEPROM_SIZE - 4);
+    *(uint16_t*)&FlashBuf[LOG_START + 2] = WORD_ONE(EEPROM_SIZE - 4);
     /* Write Log word value */
-    *(uint16_t*)&FlashBuf[LOG_BASE + 4] = WORD_NEXT(EEPROM_SIZE - 2);
-    *(uint16_t*)&FlashBuf[LOG_BASE + 6] = ~0x9abc;
+    *(uint16_t*)&FlashBuf[LOG_START + 4] = WORD_NEXT(EEPROM_SIZE - 2);
+    *(uint16_t*)&FlashBuf[LOG_START + 6] = ~0x9abc;
     /* Check values */
     EEPROM_Init();
     EXPECT_EQ(EEPROM_ReadDataWord(200), 0);
@@ -235,19 +240,19 @@ TEST_F(EepromStm32Test, TestWriteWord) {
     EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + EEPROM_SIZE - 4], (uint16_t)~0x1234);
     EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + EEPROM_SIZE - 2], (uint16_t)~0x5678);
     /* Write Log word zero-encoded */
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], WORD_ZERO(EEPROM_SIZE - 4));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], WORD_ZERO(EEPROM_SIZE - 4));
     /* Write Log word one-encoded */
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], WORD_ONE(EEPROM_SIZE - 2));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 2], WORD_ONE(EEPROM_SIZE - 2));
     /* Write Log word value aligned */
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 4], WORD_NEXT(200));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 6], (uint16_t)~0x4321);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 4], WORD_NEXT(200));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 6], (uint16_t)~0x4321);
     /* Write Log word value unaligned */
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 8], WORD_NEXT(202));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 10], (uint16_t)~0x763c);
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 12], WORD_NEXT(202));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 14], (uint16_t)~0xef3c);
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 16], WORD_NEXT(204));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 18], (uint16_t)~0x00cd);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 8], WORD_NEXT(202));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 10], (uint16_t)~0x763c);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 12], WORD_NEXT(202));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 14], (uint16_t)~0xef3c);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 16], WORD_NEXT(204));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 18], (uint16_t)~0x00cd);
 }
 
 TEST_F(EepromStm32Test, TestWordRoundTrip) {
@@ -298,31 +303,31 @@ TEST_F(EepromStm32Test, TestByteWordBoundary) {
     EEPROM_Init();
     EXPECT_EQ(EEPROM_ReadDataWord(0x7e), 0x3cad);
     EXPECT_EQ(EEPROM_ReadDataWord(0x80), 0xbe18);
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], BYTE_VALUE(0x7f, 0x3c));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], WORD_NEXT(0x80));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 4], (uint16_t)~0xbe18);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], BYTE_VALUE(0x7f, 0x3c));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 2], WORD_NEXT(0x80));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 4], (uint16_t)~0xbe18);
     /* Byte log entries */
     EEPROM_WriteDataWord(0x7e, 0xcafe);
     /* Check values */
     EEPROM_Init();
     EXPECT_EQ(EEPROM_ReadDataWord(0x7e), 0xcafe);
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 6], BYTE_VALUE(0x7e, 0xfe));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 8], BYTE_VALUE(0x7f, 0xca));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 6], BYTE_VALUE(0x7e, 0xfe));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 8], BYTE_VALUE(0x7f, 0xca));
     /* Byte and Word log entries */
     EEPROM_WriteDataWord(0x7f, 0xba5e);
     /* Check values */
     EEPROM_Init();
     EXPECT_EQ(EEPROM_ReadDataWord(0x7f), 0xba5e);
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 10], BYTE_VALUE(0x7f, 0x5e));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 12], WORD_NEXT(0x80));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 14], (uint16_t)~0xbeba);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 10], BYTE_VALUE(0x7f, 0x5e));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 12], WORD_NEXT(0x80));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 14], (uint16_t)~0xbeba);
     /* Word log entry */
     EEPROM_WriteDataWord(0x80, 0xf00d);
     /* Check values */
     EEPROM_Init();
     EXPECT_EQ(EEPROM_ReadDataWord(0x80), 0xf00d);
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 16], WORD_NEXT(0x80));
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 18], (uint16_t)~0xf00d);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 16], WORD_NEXT(0x80));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 18], (uint16_t)~0xf00d);
 }
 
 TEST_F(EepromStm32Test, TestDWordRoundTrip) {
@@ -411,11 +416,14 @@ TEST_F(EepromStm32Test, TestCompaction) {
     /* Fill write log entries */
     uint32_t i;
     uint32_t val = 0xd8453c6b;
-    for (i = 0; i < (LOG_SIZE / (sizeof(uint32_t) * 2)); i++) {
+    for (i = 0; i < ((LOG_SIZE - 4) / (sizeof(uint32_t) * 2)); i++) {
         val ^= 0x593ca5b3;
         val += i;
         eeprom_write_dword((uint32_t*)200, val);
     }
+    /* Fill the slot left over by the layout marker */
+    val ^= 0xffff;
+    eeprom_write_word((uint16_t*)200, val);
     /* Check values pre-compaction */
     EEPROM_Init();
     EXPECT_EQ(eeprom_read_dword((uint32_t*)0), 0xdeadbeef);
@@ -423,7 +431,7 @@ TEST_F(EepromStm32Test, TestCompaction) {
     EXPECT_EQ(eeprom_read_word((uint16_t*)6), 0xd00d);
     EXPECT_EQ(eeprom_read_dword((uint32_t*)150), 0xcafef00d);
     EXPECT_EQ(eeprom_read_dword((uint32_t*)200), val);
-    EXPECT_NE(*(uint16_t*)&FlashBuf[LOG_BASE], 0xFFFF);
+    EXPECT_NE(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
     EXPECT_NE(*(uint16_t*)&FlashBuf[LOG_BASE + LOG_SIZE - 2], 0xFFFF);
     /* Run compaction */
     eeprom_write_byte((uint8_t*)4, 0x1f);
@@ -433,6 +441,171 @@ TEST_F(EepromStm32Test, TestCompaction) {
     EXPECT_EQ(eeprom_read_word((uint16_t*)6), 0xd00d);
     EXPECT_EQ(eeprom_read_dword((uint32_t*)150), 0xcafef00d);
     EXPECT_EQ(eeprom_read_dword((uint32_t*)200), val);
-    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], 0xFFFF);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
     EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + LOG_SIZE - 2], 0xFFFF);
 }
+
+TEST_F(EepromStm32Test, TestReadRun) {
+    /* Direct compacted-area baseline */
+    FlashBuf[EEPROM_BASE + 200] = ~0xcd;
+    FlashBuf[EEPROM_BASE + 201] = ~0xab;
+    /* Write Log run, with an incomplete value */
+    *(uint16_t*)&FlashBuf[LOG_START]      = WORD_RUN(200);
+    *(uint16_t*)&FlashBuf[LOG_START + 2]  = 3;
+    *(uint16_t*)&FlashBuf[LOG_START + 4]  = ~0x1234;
+    *(uint16_t*)&FlashBuf[LOG_START + 6]  = 0xFFFF;
+    *(uint16_t*)&FlashBuf[LOG_START + 8]  = ~0x5678;
+    *(uint16_t*)&FlashBuf[LOG_START + 10] = WORD_ONE(202);
+    /* Check values */
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataWord(200), 0x1234);
+    EXPECT_EQ(EEPROM_ReadDataWord(202), 1);
+    EXPECT_EQ(EEPROM_ReadDataWord(204), 0x5678);
+    /* Next entry goes after the run */
+    EEPROM_WriteDataWord(200, 0);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 12], WORD_ZERO(200));
+}
+
+TEST_F(EepromStm32Test, TestWriteBlockRun) {
+    uint16_t src0[] = {0x1111, 0x2222, 0x3333, 0x4444, 0x5555, 0x6666};
+    uint16_t src1[] = {0x1111, 0xaaaa, 0xbbbb, 0xcccc, 0x0000, 0xdddd};
+    /* Direct compacted-area */
+    eeprom_write_block(src0, (void*)200, sizeof(src0));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + 200], (uint16_t)~0x1111);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + 210], (uint16_t)~0x6666);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
+    /* Only changed words are logged, consecutive ones as a run */
+    eeprom_write_block(src1, (void*)200, sizeof(src1));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], WORD_RUN(202));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 2], 3);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 4], (uint16_t)~0xaaaa);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 6], (uint16_t)~0xbbbb);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 8], (uint16_t)~0xcccc);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 10], WORD_ZERO(208));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 12], WORD_NEXT(210));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 14], (uint16_t)~0xdddd);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 16], 0xFFFF);
+    /* Check values */
+    EEPROM_Init();
+    uint16_t dst[6] = {0};
+    eeprom_read_block(dst, (void*)200, sizeof(dst));
+    EXPECT_EQ(memcmp(src1, dst, sizeof(dst)), 0);
+    /* Unaligned block */
+    eeprom_write_block((uint8_t*)src0 + 1, (void*)201, sizeof(src0) - 2);
+    EEPROM_Init();
+    eeprom_read_block(dst, (void*)200, sizeof(dst));
+    EXPECT_EQ(dst[0], 0x1111);
+    EXPECT_EQ(memcmp(&src0[1], &dst[1], sizeof(dst) - 4), 0);
+    EXPECT_EQ(dst[5], 0xdd66);
+}
+
+TEST_F(EepromStm32Test, TestLayoutMarker) {
+    /* The write log starts with the layout marker */
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], LAYOUT_MARKER);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], (uint16_t)~LAYOUT_VERSION);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
+    /* Blank flash gets one on the first boot */
+    memset(FlashBuf, 0xFF, sizeof(FlashBuf));
+    EEPROM_Init();
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], LAYOUT_MARKER);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], (uint16_t)~LAYOUT_VERSION);
+    /* Entries follow the marker */
+    EEPROM_WriteDataWord(200, 0x1234);
+    EEPROM_WriteDataWord(200, 0x5678);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], WORD_NEXT(200));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 2], (uint16_t)~0x5678);
+}
+
+TEST_F(EepromStm32Test, TestReadUnmarkedLog) {
+    /* Direct compacted-area baseline */
+    FlashBuf[EEPROM_BASE + 200] = ~0xcd;
+    FlashBuf[EEPROM_BASE + 201] = ~0xab;
+    /* Write log from firmware without the layout marker */
+    *(uint16_t*)&FlashBuf[LOG_BASE]     = WORD_NEXT(200);
+    *(uint16_t*)&FlashBuf[LOG_BASE + 2] = ~0x1234;
+    *(uint16_t*)&FlashBuf[LOG_BASE + 4] = BYTE_VALUE(3, 0x65);
+    /* Check values */
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataWord(200), 0x1234);
+    EXPECT_EQ(EEPROM_ReadDataByte(3), 0x65);
+    /* The log was compacted into the current layout */
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + 200], (uint16_t)~0x1234);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], LAYOUT_MARKER);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], (uint16_t)~LAYOUT_VERSION);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
+}
+
+TEST_F(EepromStm32Test, TestReadUnknownLayout) {
+    /* Direct compacted-area baseline */
+    FlashBuf[EEPROM_BASE + 200] = ~0xcd;
+    FlashBuf[EEPROM_BASE + 201] = ~0xab;
+    /* Write log in a layout this firmware doesn't know */
+    *(uint16_t*)&FlashBuf[LOG_BASE + 2] = ~(LAYOUT_VERSION + 1);
+    *(uint16_t*)&FlashBuf[LOG_START]     = WORD_NEXT(200);
+    *(uint16_t*)&FlashBuf[LOG_START + 2] = ~0x1234;
+    /* Only the compacted area is kept */
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataWord(200), 0xabcd);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], (uint16_t)~LAYOUT_VERSION);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
+}
+
+TEST_F(EepromStm32Test, TestReadBlockBadAddress) {
+    uint8_t dst[4] = {0};
+    eeprom_write_byte((uint8_t*)(EEPROM_SIZE - 2), 0x42);
+    eeprom_read_block(dst, (void*)(EEPROM_SIZE - 2), sizeof(dst));
+    EXPECT_EQ(dst[0], 0x42);
+    EXPECT_EQ(dst[1], 0);
+    EXPECT_EQ(dst[2], 0xFF);
+    EXPECT_EQ(dst[3], 0xFF);
+}
+
+#ifdef FEE_BACKGROUND_COMPACTION
+TEST_F(EepromStm32Test, TestBackgroundCompaction) {
+    eeprom_write_dword((uint32_t*)0, 0xdeadbeef);
+    eeprom_write_dword((uint32_t*)200, 0x12345678);
+    /* Nothing to do while the write log has room */
+    EEPROM_Task();
+    EXPECT_FALSE(EEPROM_Compacting());
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE], (uint16_t)~0xbeef);
+    /* Fill most of the write log */
+    uint32_t i;
+    uint32_t val = 0xd8453c6b;
+    for (i = 0; i < (LOG_SIZE / (sizeof(uint32_t) * 2)) * 7 / 8; i++) {
+        val ^= 0x593ca5b3;
+        val += i;
+        eeprom_write_dword((uint32_t*)200, val);
+    }
+    EXPECT_NE(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
+    /* Erase a page at a time */
+    EEPROM_Task();
+    EXPECT_TRUE(EEPROM_Compacting());
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE], 0xFFFF);
+    /* Writes in between only reach the cache */
+    eeprom_write_dword((uint32_t*)0, 0xcafef00d);
+    eeprom_write_word((uint16_t*)(EEPROM_SIZE - 2), 0x5678);
+    for (i = 0; i < FEE_PAGE_COUNT; i++) {
+        EEPROM_Task();
+    }
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], 0xFFFF);
+    /* Then program the compacted area a chunk at a time */
+    EEPROM_Task();
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE], (uint16_t)~0xf00d);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + EEPROM_SIZE - 2], 0xFFFF);
+    /* Already programmed words are logged, the rest reach the cache */
+    eeprom_write_dword((uint32_t*)0, 0xba5eba11);
+    eeprom_write_word((uint16_t*)(EEPROM_SIZE - 2), 0x9abc);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START], BYTE_VALUE(0, 0x11));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_START + 8], 0xFFFF);
+    for (i = 0; i < EEPROM_SIZE / 2; i++) {
+        EEPROM_Task();
+    }
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + EEPROM_SIZE - 2], (uint16_t)~0x9abc);
+    EXPECT_FALSE(EEPROM_Compacting());
+    /* Check values */
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)0), 0xba5eba11);
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)200), val);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)(EEPROM_SIZE - 2)), 0x9abc);
+}
+#endif
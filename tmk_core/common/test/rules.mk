@@ -8,7 +8,8 @@ eeprom_stm32_large_DEFS := $(eeprom_stm32_DEFS) \
 	-DFEE_MCU_FLASH_SIZE=64 \
 	-DMOCK_FLASH_SIZE=65536 \
 	-DFEE_PAGE_SIZE=2048 \
-	-DFEE_PAGE_COUNT=16
+	-DFEE_PAGE_COUNT=16 \
+	-DFEE_BACKGROUND_COMPACTION
 
 eeprom_stm32_INC := \
 	$(TMK_PATH)/common/chibios/
@@ -21,3 +22,10 @@ eeprom_stm32_SRC := \
 	$(TMK_PATH)/common/chibios/eeprom_stm32.c
 eeprom_stm32_tiny_SRC := $(eeprom_stm32_SRC)
 eeprom_stm32_large_SRC := $(eeprom_stm32_SRC)
+
+eeconfig_cache_DEFS := -DEECONFIG_CACHE -DNO_PRINT
+
+eeconfig_cache_SRC := \
+	$(TMK_PATH)/common/test/eeconfig_cache_tests.cpp \
+	$(TMK_PATH)/common/test/eeprom.c \
+	$(QUANTUM_PATH)/eeconfig.c
@@ -1 +1 @@
-TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large
+TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large eeconfig_cache
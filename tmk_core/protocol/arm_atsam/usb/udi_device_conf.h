@@ -128,6 +128,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 #ifdef MOUSE_ENABLE
+#    if defined(MOUSE_EXTENDED_REPORT) || defined(MOUSE_SCROLL_HIRES_ENABLE)
+#        error "MOUSE_EXTENDED_REPORT and MOUSE_SCROLL_HIRES_ENABLE are not supported by ARM ATSAM"
+#    endif
 #    define MOUSE_IN_EPNUM NEXT_IN_EPNUM_1
 #    define NEXT_IN_EPNUM_2 (MOUSE_IN_EPNUM + 1)
 #    define UDI_HID_MOU_EP_IN MOUSE_IN_EPNUM
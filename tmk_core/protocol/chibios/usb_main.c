@@ -41,6 +41,7 @@
 #include "wait.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#include "latency_probe.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -455,6 +456,10 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
             return;
 
         case USB_EVENT_CONFIGURED:
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+            // feature reports start out at their defaults in a new configuration
+            mouse_feature_report.resolution_multiplier = 0;
+#endif
             osalSysLockFromISR();
             /* Enable the endpoints specified into the configuration. */
 #ifndef KEYBOARD_SHARED_EP
@@ -489,6 +494,10 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
         case USB_EVENT_UNCONFIGURED:
             /* Falls into.*/
         case USB_EVENT_RESET:
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+            // back to notches until the host sets the multiplier again
+            mouse_feature_report.resolution_multiplier = 0;
+#endif
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 chSysLockFromISR();
                 /* Disconnection event on suspend.*/
@@ -565,6 +574,12 @@ static bool usb_request_hook_cb(USBDriver *usbp) {
             case USB_RTYPE_DIR_DEV2HOST:
                 switch (usbp->setup[1]) { /* bRequest */
                     case HID_GET_REPORT:
+#if defined(MOUSE_ENABLE) && defined(MOUSE_SCROLL_HIRES_ENABLE)
+                        if (usbp->setup[4] == MOUSE_HID_INTERFACE && usbp->setup[3] == HID_REPORT_TYPE_FEATURE) { /* LSB(wIndex), MSB(wValue) */
+                            usbSetupTransfer(usbp, (uint8_t *)&mouse_feature_report, sizeof(mouse_feature_report), NULL);
+                            return TRUE;
+                        }
+#endif
                         switch (usbp->setup[4]) { /* LSB(wIndex) (check MSB==0?) */
                             case KEYBOARD_INTERFACE:
                                 usbSetupTransfer(usbp, (uint8_t *)&keyboard_report_sent, sizeof(keyboard_report_sent), NULL);
@@ -602,6 +617,13 @@ static bool usb_request_hook_cb(USBDriver *usbp) {
             case USB_RTYPE_DIR_HOST2DEV:
                 switch (usbp->setup[1]) { /* bRequest */
                     case HID_SET_REPORT:
+#if defined(MOUSE_ENABLE) && defined(MOUSE_SCROLL_HIRES_ENABLE)
+                        /* the host enabling the resolution multiplier */
+                        if (usbp->setup[4] == MOUSE_HID_INTERFACE && usbp->setup[3] == HID_REPORT_TYPE_FEATURE) { /* LSB(wIndex), MSB(wValue) */
+                            usbSetupTransfer(usbp, (uint8_t *)&mouse_feature_report, sizeof(mouse_feature_report), NULL);
+                            return TRUE;
+                        }
+#endif
                         switch (usbp->setup[4]) { /* LSB(wIndex) (check MSB==0?) */
                             case KEYBOARD_INTERFACE:
 #if defined(SHARED_EP_ENABLE) && !defined(KEYBOARD_SHARED_EP)
@@ -748,9 +770,9 @@ __attribute__((weak)) void restart_usb_driver(USBDriver *usbp) {
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+    latency_probe_complete(ep);
 }
 #endif
 
@@ -822,6 +844,7 @@ void send_keyboard(report_keyboard_t *report) {
             }
         }
         usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
+        latency_probe_transmit(SHARED_IN_EPNUM);
     } else
 #endif /* NKRO_ENABLE */
     {  /* regular protocol */
@@ -848,6 +871,7 @@ void send_keyboard(report_keyboard_t *report) {
             size = 8;
         }
         usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, data, size);
+        latency_probe_transmit(KEYBOARD_IN_EPNUM);
     }
     keyboard_report_sent = *report;
 
@@ -902,9 +926,9 @@ void send_mouse(report_mouse_t *report) { (void)report; }
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
 void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+    latency_probe_complete(ep);
 }
 #endif
 
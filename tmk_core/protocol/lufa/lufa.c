@@ -52,6 +52,7 @@
 #include "usb_descriptor.h"
 #include "lufa.h"
 #include "quantum.h"
+#include "latency_probe.h"
 #include <util/atomic.h>
 
 #ifdef NKRO_ENABLE
@@ -413,7 +414,13 @@ void EVENT_USB_Device_Disconnect(void) {
  *
  * FIXME: Needs doc
  */
-void EVENT_USB_Device_Reset(void) { print("[R]"); }
+void EVENT_USB_Device_Reset(void) {
+    print("[R]");
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+    // back to notches until the host sets the multiplier again
+    mouse_feature_report.resolution_multiplier = 0;
+#endif
+}
 
 /** \brief Event USB Device Connect
  *
@@ -477,6 +484,11 @@ void EVENT_USB_Device_StartOfFrame(void) {
 void EVENT_USB_Device_ConfigurationChanged(void) {
     bool ConfigSuccess = true;
 
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+    // feature reports start out at their defaults in a new configuration
+    mouse_feature_report.resolution_multiplier = 0;
+#endif
+
 #ifndef KEYBOARD_SHARED_EP
     /* Setup keyboard report endpoint */
     ConfigSuccess &= Endpoint_ConfigureEndpoint((KEYBOARD_IN_EPNUM | ENDPOINT_DIR_IN), EP_TYPE_INTERRUPT, KEYBOARD_EPSIZE, 1);
@@ -565,6 +577,12 @@ void EVENT_USB_Device_ControlRequest(void) {
                         ReportSize = sizeof(keyboard_report_sent);
                         break;
                 }
+#if defined(MOUSE_ENABLE) && defined(MOUSE_SCROLL_HIRES_ENABLE)
+                if (USB_ControlRequest.wIndex == MOUSE_HID_INTERFACE && (USB_ControlRequest.wValue >> 8) == HID_REPORT_TYPE_FEATURE) {
+                    ReportData = (uint8_t *)&mouse_feature_report;
+                    ReportSize = sizeof(mouse_feature_report);
+                }
+#endif
 
                 /* Write the report data to the control endpoint */
                 Endpoint_Write_Control_Stream_LE(ReportData, ReportSize);
@@ -574,6 +592,15 @@ void EVENT_USB_Device_ControlRequest(void) {
             break;
         case HID_REQ_SetReport:
             if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE)) {
+#if defined(MOUSE_ENABLE) && defined(MOUSE_SCROLL_HIRES_ENABLE)
+                // the host enabling the resolution multiplier
+                if (USB_ControlRequest.wIndex == MOUSE_HID_INTERFACE && (USB_ControlRequest.wValue >> 8) == HID_REPORT_TYPE_FEATURE) {
+                    Endpoint_ClearSETUP();
+                    Endpoint_Read_Control_Stream_LE(&mouse_feature_report, sizeof(mouse_feature_report));
+                    Endpoint_ClearIN();
+                    break;
+                }
+#endif
                 // Interface
                 switch (USB_ControlRequest.wIndex) {
                     case KEYBOARD_INTERFACE:
@@ -714,9 +741,25 @@ static void send_keyboard(report_keyboard_t *report) {
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
 
+    /* There is no completion callback, so the report counts as sent once the bank is handed over */
+    latency_probe_transmit(ep);
+    latency_probe_complete(ep);
+
     keyboard_report_sent = *report;
 }
 
+#if defined(MOUSE_ENABLE) && defined(BLUETOOTH_ENABLE)
+/** \brief Clamp a mouse report value to the 8 bits Bluetooth reports carry
+ *
+ * Movement beyond that range is dropped, as with MOUSE_EXTENDED_REPORT disabled.
+ */
+static int8_t bluetooth_mouse_clamp(int16_t value) {
+    if (value > 127) return 127;
+    if (value < -127) return -127;
+    return value;
+}
+#endif
+
 /** \brief Send Mouse
  *
  * FIXME: Needs doc
@@ -727,18 +770,23 @@ static void send_mouse(report_mouse_t *report) {
 
 #    ifdef BLUETOOTH_ENABLE
     if (where_to_send() == OUTPUT_BLUETOOTH) {
+        // Bluetooth reports are 8 bits in whole notches, whatever the USB host has set up
+        int8_t x = bluetooth_mouse_clamp(report->x);
+        int8_t y = bluetooth_mouse_clamp(report->y);
+        int8_t v = bluetooth_mouse_clamp(report->v / host_mouse_scroll_multiplier());
+        int8_t h = bluetooth_mouse_clamp(report->h / host_mouse_scroll_multiplier());
 #        ifdef MODULE_ADAFRUIT_BLE
         // FIXME: mouse buttons
-        adafruit_ble_send_mouse_move(report->x, report->y, report->v, report->h, report->buttons);
+        adafruit_ble_send_mouse_move(x, y, v, h, report->buttons);
 #        else
         serial_send(0xFD);
         serial_send(0x00);
         serial_send(0x03);
         serial_send(report->buttons);
-        serial_send(report->x);
-        serial_send(report->y);
-        serial_send(report->v);  // should try sending the wheel v here
-        serial_send(report->h);  // should try sending the wheel h here
+        serial_send(x);
+        serial_send(y);
+        serial_send(v);  // should try sending the wheel v here
+        serial_send(h);  // should try sending the wheel h here
         serial_send(0x00);
 #        endif
         return;
@@ -39,6 +39,7 @@ static inline void ps2_mouse_convert_report_to_hid(report_mouse_t *mouse_report)
 static inline void ps2_mouse_clear_report(report_mouse_t *mouse_report);
 static inline void ps2_mouse_enable_scrolling(void);
 static inline void ps2_mouse_scroll_button_task(report_mouse_t *mouse_report);
+static inline void ps2_mouse_host_send(report_mouse_t *mouse_report);
 
 /* ============================= IMPLEMENTATION ============================ */
 
@@ -111,7 +112,7 @@ void ps2_mouse_task(void) {
         // Used to debug the bytes sent to the host
         ps2_mouse_print_report(&mouse_report);
 #endif
-        host_mouse_send(&mouse_report);
+        ps2_mouse_host_send(&mouse_report);
     }
 
     ps2_mouse_clear_report(&mouse_report);
@@ -213,6 +214,18 @@ static inline void ps2_mouse_print_report(report_mouse_t *mouse_report) {
     print("]\n");
 }
 
+static inline void ps2_mouse_host_send(report_mouse_t *mouse_report) {
+#ifdef MOUSE_SCROLL_HIRES_ENABLE
+    // the wheel is read in notches, the host may want fractions of one
+    report_mouse_t report = *mouse_report;
+    report.v *= host_mouse_scroll_multiplier();
+    report.h *= host_mouse_scroll_multiplier();
+    host_mouse_send(&report);
+#else
+    host_mouse_send(mouse_report);
+#endif
+}
+
 static inline void ps2_mouse_enable_scrolling(void) {
     PS2_MOUSE_SEND(PS2_MOUSE_SET_SAMPLE_RATE, "Initiaing scroll wheel enable: Set sample rate");
     PS2_MOUSE_SEND(200, "200");
@@ -262,7 +275,7 @@ static inline void ps2_mouse_scroll_button_task(report_mouse_t *mouse_report) {
 #if PS2_MOUSE_SCROLL_BTN_SEND
         if (scroll_state == SCROLL_BTN && timer_elapsed(scroll_button_time) < PS2_MOUSE_SCROLL_BTN_SEND) {
             PRESS_SCROLL_BUTTONS;
-            host_mouse_send(mouse_report);
+            ps2_mouse_host_send(mouse_report);
             wait_ms(100);
             RELEASE_SCROLL_BUTTONS;
         }
@@ -67,16 +67,16 @@ void serial_mouse_task(void) {
 
 #ifdef SERIAL_MOUSE_CENTER_SCROLL
     if ((buffer[0] & 0x7) == 0x5 && (buffer[1] || buffer[2])) {
-        /* USB HID uses only values from -127 to 127 */
-        report.h = MAX((int8_t)buffer[1], -127);
-        report.v = MAX((int8_t)buffer[2], -127);
+        /* USB HID uses only values from -127 to 127, in notches until the host asks for finer steps */
+        report.h = MAX((int8_t)buffer[1], -127) * host_mouse_scroll_multiplier();
+        report.v = MAX((int8_t)buffer[2], -127) * host_mouse_scroll_multiplier();
 
         print_usb_data(&report);
         host_mouse_send(&report);
 
         if (buffer[3] || buffer[4]) {
-            report.h = MAX((int8_t)buffer[3], -127);
-            report.v = MAX((int8_t)buffer[4], -127);
+            report.h = MAX((int8_t)buffer[3], -127) * host_mouse_scroll_multiplier();
+            report.v = MAX((int8_t)buffer[4], -127) * host_mouse_scroll_multiplier();
 
             print_usb_data(&report);
             host_mouse_send(&report);
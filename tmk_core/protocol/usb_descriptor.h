@@ -194,6 +194,15 @@ enum usb_interfaces {
     TOTAL_INTERFACES
 };
 
+#ifdef MOUSE_SHARED_EP
+#    define MOUSE_HID_INTERFACE SHARED_INTERFACE
+#else
+#    define MOUSE_HID_INTERFACE MOUSE_INTERFACE
+#endif
+
+/* Report type in the high byte of wValue of HID Get_Report and Set_Report requests */
+#define HID_REPORT_TYPE_FEATURE 0x03
+
 #define NEXT_EPNUM __COUNTER__
 
 /*
@@ -301,7 +310,11 @@ enum usb_endpoints {
 
 #define KEYBOARD_EPSIZE 8
 #define SHARED_EPSIZE 32
-#define MOUSE_EPSIZE 8
+#if defined(MOUSE_EXTENDED_REPORT) || defined(MOUSE_SCROLL_HIRES_ENABLE)
+#    define MOUSE_EPSIZE 16
+#else
+#    define MOUSE_EPSIZE 8
+#endif
 #define RAW_EPSIZE 32
 #define CONSOLE_EPSIZE 32
 #define MIDI_STREAM_EPSIZE 64
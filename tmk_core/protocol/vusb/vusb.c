@@ -81,6 +81,10 @@ enum usb_interfaces {
 #    error Mouse/Extra Keys share an endpoint with Console. Please disable one of the two.
 #endif
 
+#if defined(MOUSE_ENABLE) && (defined(MOUSE_EXTENDED_REPORT) || defined(MOUSE_SCROLL_HIRES_ENABLE))
+#    error MOUSE_EXTENDED_REPORT and MOUSE_SCROLL_HIRES_ENABLE are not supported by V-USB
+#endif
+
 static uint8_t keyboard_led_state = 0;
 static uint8_t vusb_idle_rate     = 0;
 